@@ -2,6 +2,10 @@
     \brief This class provides the utilities to benchmark Fast Marching Solvers (configuration, running and logging).
     It works for FMM (any heap and SFMM), FIM and UFMM. It has not been tested
     with FM2 solvers.
+
+    If reference arrival times are given (setReference()), for instance those of the same
+    solvers on a double precision grid (getSolutions()) or the exact solution of the
+    problem, the maximum and mean absolute errors of every run are logged after the times.
     
     By default, it will save a log file in a generated folder called results.
     
@@ -20,8 +24,14 @@
 #ifndef BENCHMARK_HPP_
 #define BENCHMARK_HPP_
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <iomanip>
 #include <limits>
+#include <map>
+#include <string>
+#include <vector>
 
 #include <boost/filesystem.hpp>
 #include <boost/progress.hpp>
@@ -32,6 +42,9 @@
 template <class grid_t>
 class Benchmark {
 
+    /** \brief Shorthand for the index type of the grid. */
+    typedef typename grid_t::index_t index_t;
+
     public:
 
         Benchmark
@@ -42,7 +55,10 @@ class Benchmark {
         nruns_(10),
         path_("results"),
         name_("benchmark"),
-        fromCFG_(false){}
+        fromCFG_(false),
+        keepSolutions_(false),
+        maxError_(0),
+        meanError_(0){}
 
         virtual ~Benchmark()
         {
@@ -91,15 +107,43 @@ class Benchmark {
             saveLog_ = s;
         }
 
+        /** \brief If true, the arrival times of the last run of each solver are kept (see getSolutions()). */
+        void setKeepSolutions
+        (bool k) {
+            keepSolutions_ = k;
+        }
+
+        /** \brief Returns the arrival times of the last run of each solver, by solver name. Only
+            if setKeepSolutions(true) was called before run(). */
+        const std::map<std::string, std::vector<double> > & getSolutions
+        () const {
+            return solutions_;
+        }
+
+        /** \brief Sets the arrival times the runs are compared with, by solver name: each
+            solver is compared with the reference of the same name. The grid has to have
+            the same dimensions and layout. */
+        void setReference
+        (const std::map<std::string, std::vector<double> > & reference) {
+            reference_ = reference;
+        }
+
+        /** \brief Sets the arrival times all the solvers without a reference of their own
+            are compared with (the exact solution, for instance). */
+        void setReference
+        (const std::vector<double> & reference) {
+            commonReference_ = reference;
+        }
+
         /** \brief Sets the initial and goal points (indices) for the solvers. */
         void setInitialAndGoalPoints
-        (const std::vector<unsigned int> & init_points, unsigned int goal_idx) {
+        (const std::vector<index_t> & init_points, index_t goal_idx) {
             init_points_ = init_points;
             goal_idx_ = goal_idx;
         }
 
         /** \brief Sets the initial points (indices for the solvers). */
-        void setInitialPoints(const std::vector<unsigned int> & init_points)
+        void setInitialPoints(const std::vector<index_t> & init_points)
         {
             setInitialAndGoalPoints(init_points, -1);
         }
@@ -126,18 +170,23 @@ class Benchmark {
                 for (unsigned int i = 0; i < nruns_; ++i)
                 {
                     ++runID_;
-                    s->reset();
                     s->compute();
-                    logRun(s);
 
-                    if (saveGrid_ == 2)
+                    if (saveGrid_ == 2 || (saveGrid_ == 1 && i == nruns_-1))
                         saveGrid(s);
+                    if (keepSolutions_ && i == nruns_-1)
+                        keepSolution(s);
+                    if (hasReference())
+                        computeError(s);
+
+                    // The reset after each run is timed apart.
+                    start_ = std::chrono::steady_clock::now();
+                    s->reset();
+                    end_ = std::chrono::steady_clock::now();
+                    logRun(s, std::chrono::duration_cast<std::chrono::microseconds>(end_-start_).count()/1000.0);
 
                     ++showProgress;
                 }
-                if (saveGrid_ == 1)
-                    saveGrid(s);
-                s->reset();                
             }
 
             if (saveLog_)
@@ -145,14 +194,18 @@ class Benchmark {
             else {
                 console::info("Benchmark log format:");
                 std::cout << "Name\t#Runs\t#Dims\tDim1...DimN\t#Starts\tStartIdx\tGoalIdx"<<'\n';
-                std::cout << "RunID\tName\tTime (ms)" << '\n';
+                std::cout << "RunID\tName\tTime (ms)\tReset time (ms)";
+                if (hasReference())
+                    std::cout << "\tMax error\tMean error";
+                std::cout << '\n';
                 std::cout << log_.str() << '\n';
             }
         }
 
-        /** \brief  Logs the last run of solver s. */
+        /** \brief  Logs the last run of solver s and the time spent resetting it. Also its
+            errors if a reference is set. */
         void logRun
-        (const Solver<grid_t>* s)
+        (const Solver<grid_t>* s, double resetTime)
         {
             std::ios init(NULL);
             init.copyfmt(std::cout);
@@ -160,7 +213,9 @@ class Benchmark {
             log_ << '\n' << fmtID_;
 
             std::cout.copyfmt(init);
-            log_ << '\t' << s->getName() << "\t" << s->getTime();
+            log_ << '\t' << s->getName() << "\t" << s->getTime() << '\t' << resetTime;
+            if (hasReference())
+                log_ << '\t' << maxError_ << '\t' << meanError_;
         }
 
         /** \brief Saves the grid values result of the last run of solver s. */
@@ -212,9 +267,9 @@ class Benchmark {
 
             // Saving starting points.
             log_ << init_points_.size() << '\t';
-            std::copy(init_points_.begin(), init_points_.end(), std::ostream_iterator<unsigned int>(log_, "\t"));
+            std::copy(init_points_.begin(), init_points_.end(), std::ostream_iterator<index_t>(log_, "\t"));
 
-            if (int(goal_idx_) == -1)
+            if (goal_idx_ == index_t(-1))
                 log_ << "nan";
             else
                 log_ << goal_idx_;
@@ -230,6 +285,48 @@ class Benchmark {
             }
         }
 
+        /** \brief Returns true if any reference was set, so that errors are logged. */
+        bool hasReference
+        () const {
+            return !reference_.empty() || !commonReference_.empty();
+        }
+
+        /** \brief Stores the arrival times of solver s in solutions_. */
+        void keepSolution
+        (const Solver<grid_t>* s) {
+            const grid_t * grid = s->getGrid();
+            std::vector<double> & times = solutions_[s->getName()];
+            times.resize(grid->size());
+            for (size_t i = 0; i < times.size(); ++i)
+                times[i] = grid->getCell(i).getArrivalTime();
+        }
+
+        /** \brief Computes the maximum and mean absolute errors of the arrival times of solver s
+            with respect to its reference. Cells not reached in the reference are not taken into
+            account. Errors are NaN if there is no reference for s. */
+        void computeError
+        (const Solver<grid_t>* s) {
+            maxError_ = meanError_ = std::numeric_limits<double>::quiet_NaN();
+            const auto ref = reference_.find(s->getName());
+            if (ref == reference_.end() && commonReference_.empty())
+                return;
+
+            const grid_t * grid = s->getGrid();
+            const std::vector<double> & times = ref != reference_.end() ? ref->second : commonReference_;
+            double sum = 0;
+            size_t n = 0;
+            maxError_ = 0;
+            for (size_t i = 0; i < times.size() && i < grid->size(); ++i) {
+                if (std::isinf(times[i]))
+                    continue;
+                const double error = std::fabs(grid->getCell(i).getArrivalTime() - times[i]);
+                maxError_ = std::max(maxError_, error);
+                sum += error;
+                ++n;
+            }
+            meanError_ = n ? sum/n : 0;
+        }
+
         /** \brief Formats as a string the run ID. */
         void formatID
         () {
@@ -247,13 +344,13 @@ class Benchmark {
         grid_t *                                            grid_;
 
         /** \brief Indices of the initial points. */
-        std::vector<unsigned int>                           init_points_;
+        std::vector<index_t>                                init_points_;
         
         /** \brief Index of the goal point. */
-        unsigned int                                        goal_idx_;
+        index_t                                             goal_idx_;
 
         /** \brief Time measurement variables. */        
-        std::chrono::time_point<std::chrono::system_clock>  start_, end_;
+        std::chrono::time_point<std::chrono::steady_clock>  start_, end_;
 
         /** \brief Log stream. */
         std::stringstream                                   log_;
@@ -282,6 +379,24 @@ class Benchmark {
 
         /** \brief If true, benchmark configured from CFG file, used to selectively free memory. */
         bool                                                fromCFG_;
+
+        /** \brief If true, the arrival times of the last run of each solver are kept in solutions_. */
+        bool                                                keepSolutions_;
+
+        /** \brief Arrival times of the last run of each solver, by name. */
+        std::map<std::string, std::vector<double> >         solutions_;
+
+        /** \brief Reference arrival times of each solver, by name. */
+        std::map<std::string, std::vector<double> >         reference_;
+
+        /** \brief Reference arrival times of the solvers not in reference_. */
+        std::vector<double>                                 commonReference_;
+
+        /** \brief Maximum absolute error of the last run. */
+        double                                              maxError_;
+
+        /** \brief Mean absolute error of the last run. */
+        double                                              meanError_;
 };
 
 #endif /* BENCHMARK_HPP_*/
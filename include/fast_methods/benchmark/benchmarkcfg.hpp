@@ -20,6 +20,10 @@
 #include <string>
 #include <unordered_map>
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 #include <boost/program_options.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
@@ -28,6 +32,7 @@
 #include <fast_methods/io/maploader.hpp>
 
 #include <fast_methods/fm/fmm.hpp>
+#include <fast_methods/fm/sofmm.hpp>
 #include <fast_methods/fm/sfmm.hpp>
 #include <fast_methods/fm/fmmstar.hpp>
 #include <fast_methods/fm/sfmmstar.hpp>
@@ -38,6 +43,11 @@
 #include <fast_methods/fm/lsm.hpp>
 #include <fast_methods/fm/ddqm.hpp>
 
+#include <fast_methods/datastructures/fmdaryheap.hpp>
+#include <fast_methods/datastructures/fmhandlestorage.hpp>
+#include <fast_methods/datastructures/fmindexedheap.hpp>
+#include <fast_methods/datastructures/fmradixheap.hpp>
+
 /// \todo the getter functions do not check if the types are admissible.
 /// \todo does not have support for multiple starts or goals.
 /// \todo the way ctor parameters are given could be improved (as declareParams in OMPL - command pattern).
@@ -61,7 +71,8 @@ class BenchmarkCFG {
         {
             static const std::vector<std::string> knownSolvers = {
                 "fmm", "fmmstar", "fmmfib", "fmmfibstar", "sfmm", "sfmmstar",
-                "gmm", "fim", "ufmm", "fsm", "lsm", "ddqm" // Add solver here.
+                "gmm", "fim", "ufmm", "fsm", "lsm", "ddqm", "sofmm", "fmm4ary", "fmm8ary", "fmmradix",
+                "fmmpaged", "fmmstarpaged" // Add solver here.
             };
 
             std::fstream cfg(filename);
@@ -81,15 +92,21 @@ class BenchmarkCFG {
             desc.add_options()
                 ("grid.file",          boost::program_options::value<std::string>(),                             "Path to load a velocities map from image.")
                 ("grid.text",          boost::program_options::value<std::string>(),                             "Path to load a velocities map from a .grid file.")
+                ("grid.binary",        boost::program_options::value<std::string>(),                             "Path to load a velocities map from a binary grid file.")
                 ("grid.ndims",         boost::program_options::value<std::string>()->default_value("2"),         "Number of dimensions.")
-                ("grid.cell",          boost::program_options::value<std::string>()->default_value("FMCell"),    "Type of cell. FMCell by default.")
+                ("grid.cell",          boost::program_options::value<std::string>()->default_value("FMCell"),    "Type of cell: FMCell (default), FMCellSoA, FMCellSparse, FMCellMapped, FMCellShared or FMCellFloat.")
+                ("grid.layout",        boost::program_options::value<std::string>()->default_value("Linear"),    "Memory layout of the grid: Linear (default), Padded, Brick or Morton.")
+                ("grid.index",         boost::program_options::value<std::string>()->default_value("32"),        "Bits of the cell indices: 32 (default) or 64. Not for FMCell.")
                 ("grid.dimsize",       boost::program_options::value<std::string>()->default_value("200,200"),   "Size of dimensions: N,M,O...")
                 ("grid.leafsize",      boost::program_options::value<std::string>()->default_value("1"),         "Leafsize (assuming cubic cells).")
+                ("grid.slowness",      boost::program_options::value<std::string>()->default_value("0"),         "1 to precompute the slowness (leafsize/velocity) of the cells.")
                 ("problem.start",      boost::program_options::value<std::string>()->required(),                 "Start point: s1,s2,s3...")
                 ("problem.goal",       boost::program_options::value<std::string>()->default_value("nan"),       "Goal point: g1,g2,g3... By default no goal point.")
+                ("problem.factored",   boost::program_options::value<std::string>()->default_value("0"),         "1 to solve the factored Eikonal equation around the start point.")
                 ("benchmark.name",     boost::program_options::value<std::string>()->default_value(name.string()), "Name of the benchmark.")
                 ("benchmark.runs",     boost::program_options::value<std::string>()->default_value("10"),        "Number of runs per solver.")
-                ("benchmark.savegrid", boost::program_options::value<std::string>()->default_value("0"),         "Save grid values of each run.");
+                ("benchmark.savegrid", boost::program_options::value<std::string>()->default_value("0"),         "Save grid values of each run.")
+                ("benchmark.exact",    boost::program_options::value<std::string>()->default_value("0"),         "1 to log the errors with respect to the exact solution. Only for uniform maps without obstacles.");
 
             boost::program_options::variables_map vm;
             boost::program_options::parsed_options po = boost::program_options::parse_config_file(cfg, desc, true);
@@ -169,6 +186,18 @@ class BenchmarkCFG {
                         solver = new LSM<grid_t>();
                     else if (name == "ddqm")
                         solver = new DDQM<grid_t>();
+                    else if (name == "sofmm")
+                        solver = new SOFMM<grid_t>();
+                    else if (name == "fmm4ary")
+                        solver = new FMM<grid_t, FMIndexedHeap<cell_t, 4> >("FMM4ary");
+                    else if (name == "fmm8ary")
+                        solver = new FMM<grid_t, FMIndexedHeap<cell_t, 8> >("FMM8ary");
+                    else if (name == "fmmradix")
+                        solver = new FMM<grid_t, FMRadixHeap<cell_t> >("FMMRadix");
+                    else if (name == "fmmpaged")
+                        solver = new FMM<grid_t, FMDaryHeap<cell_t, FMPagedStorage> >("FMMPaged");
+                    else if (name == "fmmstarpaged")
+                        solver = new FMMStar<grid_t, FMDaryHeap<cell_t, FMPagedStorage> >("FMMPaged*");
                     // Add solver here.
 
                     else
@@ -238,6 +267,8 @@ class BenchmarkCFG {
                             solver = new UFMM<grid_t>(p[0].c_str(), boost::lexical_cast<unsigned>(p[1]));
                         else if (p.size() == 3)
                             solver = new UFMM<grid_t>(p[0].c_str(), boost::lexical_cast<unsigned>(p[1]), boost::lexical_cast<double>(p[2]));
+                        else if (p.size() == 4)
+                            solver = new UFMM<grid_t>(p[0].c_str(), boost::lexical_cast<unsigned>(p[1]), boost::lexical_cast<double>(p[2]), boost::lexical_cast<bool>(p[3]));
                     }
                     // FSM
                     else if (name == "fsm") {
@@ -257,12 +288,39 @@ class BenchmarkCFG {
                     else if (name == "ddqm") {
                         solver = new LSM<grid_t>(p[0].c_str());
                     }
+                    // SOFMM
+                    else if (name == "sofmm")
+                        solver = new SOFMM<grid_t>(ctorParams_[i].c_str());
+                    // FMM with indexed 4-ary and 8-ary heaps
+                    else if (name == "fmm4ary")
+                        solver = new FMM<grid_t, FMIndexedHeap<cell_t, 4> >(ctorParams_[i].c_str());
+                    else if (name == "fmm8ary")
+                        solver = new FMM<grid_t, FMIndexedHeap<cell_t, 8> >(ctorParams_[i].c_str());
+                    // FMM with radix heap
+                    else if (name == "fmmradix")
+                        solver = new FMM<grid_t, FMRadixHeap<cell_t> >(ctorParams_[i].c_str());
+                    // FMM and FMM* with paged heap handles
+                    else if (name == "fmmpaged")
+                        solver = new FMM<grid_t, FMDaryHeap<cell_t, FMPagedStorage> >(ctorParams_[i].c_str());
+                    else if (name == "fmmstarpaged") {
+                        if (p.size() == 1)
+                            solver = new FMMStar<grid_t, FMDaryHeap<cell_t, FMPagedStorage> >(p[0].c_str());
+                        else if (p.size() == 2) {
+                            if (p[1] == "TIME")
+                                solver = new FMMStar<grid_t, FMDaryHeap<cell_t, FMPagedStorage> >(p[0].c_str(), TIME);
+                            else if (p[1] == "DISTANCE")
+                                solver = new FMMStar<grid_t, FMDaryHeap<cell_t, FMPagedStorage> >(p[0].c_str(), DISTANCE);
+                        }
+                    }
                     // Add solver here.
 
                     else
                         continue;
                 }
 
+                if (getValue<bool>("problem.factored"))
+                    solver->template as<EikonalSolver<grid_t> >()->setFactored(true);
+
                 b.addSolver(solver);
             }
 
@@ -274,6 +332,10 @@ class BenchmarkCFG {
                 if(!MapLoader::loadMapFromText(options_.find("grid.text")->second.c_str(), *grid))
                     exit(1);
             }
+            else if (options_.find("grid.binary") != options_.end()) {
+                if(!MapLoader::loadMapFromBinary(options_.find("grid.binary")->second.c_str(), *grid))
+                    exit(1);
+            }
             else {
                 const std::string & strToSplit = options_.find("grid.dimsize")->second;
                 std::array<unsigned int, N> dimSize = splitAndCast<unsigned int, N>(strToSplit);
@@ -281,25 +343,25 @@ class BenchmarkCFG {
             }
 
             grid->setLeafSize(getValue<double>("grid.leafsize"));
+            grid->setPrecomputedSlowness(getValue<bool>("grid.slowness"));
 
             const std::string & strToSplit2 = options_.find("problem.start")->second;
             std::array<unsigned int, N> startCoords = splitAndCast<unsigned int, N>(strToSplit2);
-            unsigned int startIdx;
-            std::vector<unsigned int> startIndices;
-            grid->coord2idx(startCoords, startIdx);
-            startIndices.push_back(startIdx);
+            std::vector<typename grid_t::index_t> startIndices;
+            startIndices.push_back(grid->coord2idx(startCoords));
 
             const std::string & strToSplit3 = options_.find("problem.goal")->second;
             if (strToSplit3 != "nan")
             {
-                unsigned int goalIdx;
                 std::array<unsigned int, N> goalCoords = splitAndCast<unsigned int, N>(strToSplit3);
-                grid->coord2idx(goalCoords, goalIdx);
-                b.setInitialAndGoalPoints(startIndices, goalIdx);
+                b.setInitialAndGoalPoints(startIndices, grid->coord2idx(goalCoords));
             }
             else
                 b.setInitialPoints(startIndices);
 
+            if (getValue<bool>("benchmark.exact"))
+                b.setReference(exactSolution(*grid, startCoords));
+
             b.setEnvironment(grid);
         }
 
@@ -315,6 +377,37 @@ class BenchmarkCFG {
         }
 
     private:
+        /** \brief Returns the exact arrival times from the start point, distance * leafsize / velocity,
+            if the grid has no obstacles and a uniform velocity. Otherwise, there is no closed form
+            solution: a warning is shown and an empty vector returned (no errors logged). Slots
+            which are not cells of the grid (padding of the layout) are set to infinity, so that
+            they are not taken into account. */
+        template <class grid_t, size_t N>
+        std::vector<double> exactSolution
+        (grid_t & grid, const std::array<unsigned int, N> & start) const {
+            std::vector<typename grid_t::index_t> obs;
+            grid.getOccupiedCells(obs);
+            if (!obs.empty() || grid.getAvgSpeed() < grid.getMaxSpeed() - utils::COMP_MARGIN) {
+                console::warning("benchmark.exact ignored: the map has obstacles or non-uniform velocities.");
+                return std::vector<double>();
+            }
+
+            const double scale = grid.getLeafSize() / grid.getMaxSpeed();
+            std::vector<double> times(grid.size(), std::numeric_limits<double>::infinity());
+            std::array<unsigned int, N> coords;
+            for (typename grid_t::index_t n = 0; n < grid.getNCells(); ++n) {
+                const typename grid_t::index_t idx = grid.rowMajor2idx(n);
+                grid.idx2coord(idx, coords);
+                double dist2 = 0;
+                for (size_t d = 0; d < N; ++d) {
+                    const double diff = double(coords[d]) - double(start[d]);
+                    dist2 += diff*diff;
+                }
+                times[idx] = std::sqrt(dist2) * scale;
+            }
+            return times;
+        }
+
         // Based on http://stackoverflow.com/a/236803/2283531
         /** \brief From a string of format XXX,YY,ZZZ,... splis the N elements and cast as type T (comma-separated) as an array. */
         template <typename T, size_t N>
@@ -1,6 +1,10 @@
 /*! \struct FMCompare
     \brief Compare function to be used with FM-based heaps, concretely
     FMDaryHeap, FMFibHeap and FMPriorityQueue.
+
+    Heaps do not store pointers to the cells but FMHeapEntry elements, which
+    keep the key (total value) of the cell together with its index. This way,
+    heaps do not depend on how the grid stores the cells (see FMCellSoA).
     
     Copyright (C) 2014 Javier V. Gomez and Jose Pardeiro
     www.javiervgomez.com
@@ -20,15 +24,31 @@
 #ifndef FMCOMPARE_H_
 #define FMCOMPARE_H_
 
+#include <cstddef>
+
 #include <fast_methods/ndgridmap/fmcell.h>
 
+/** \brief Element stored in the FM-based heaps: cell index and its key when
+    pushed (or increased). The index is size_t so that any grid can be used: the
+    entry takes 16 bytes with a 32-bit index anyway because of the alignment. */
+struct FMHeapEntry {
+    FMHeapEntry
+    (double key = 0, size_t idx = 0) : key(key), idx(idx) {}
+
+    /** \brief Total value of the cell (arrival time plus heuristic). */
+    double key;
+
+    /** \brief Index of the cell within the grid. */
+    size_t idx;
+};
+
 /** \brief This struct is used a comparator for the heap. Since a minimum-heap
     is desired the operation checked is param1 > param2 as seen in this
     [Stack Overflow post](http://stackoverflow.com/a/16706002/2283531). */
-template <class cell_t> struct FMCompare {
+struct FMCompare {
     inline bool operator()
-    (const cell_t * c1 , const cell_t * c2) const {
-        return c1->getTotalValue() > c2->getTotalValue();
+    (const FMHeapEntry & e1 , const FMHeapEntry & e2) const {
+        return e1.key > e2.key;
     }
 };
 
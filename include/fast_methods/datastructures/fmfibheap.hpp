@@ -1,6 +1,9 @@
 /*! \class FMDaryHeap
     \brief Wrap for the Boost Fibonacci Heap class to be used in the FM 
     algorithms. Ready to be used with FMCell and derived types.
+
+    As in FMDaryHeap, the storage of the handles is a template parameter (FMDenseStorage by
+    default, or FMPagedStorage).
     
     Copyright (C) 2014 Javier V. Gomez and Jose Pardeiro
     www.javiervgomez.com
@@ -23,12 +26,12 @@
 #include <boost/heap/fibonacci_heap.hpp>
 
 #include <fast_methods/datastructures/fmcompare.hpp>
+#include <fast_methods/datastructures/fmhandlestorage.hpp>
 
-/// \note for memory efficiency, use map instead of vector for handles_.
-template <class cell_t = FMCell> class FMFibHeap {
+template <class cell_t = FMCell, template <class> class storage_t = FMDenseStorage> class FMFibHeap {
 
     /** \brief Shorthand for heap type. */
-    typedef boost::heap::fibonacci_heap<const cell_t *, boost::heap::compare<FMCompare<cell_t> > > fib_heap_t;
+    typedef boost::heap::fibonacci_heap<FMHeapEntry, boost::heap::compare<FMCompare> > fib_heap_t;
 
     /** \brief Shorthand for heap element handle type. */
     typedef typename fib_heap_t::handle_type handle_t;
@@ -48,14 +51,14 @@ template <class cell_t = FMCell> class FMFibHeap {
 
         /** \brief Pushes a new element into the heap. */
         void push
-        (const cell_t * c) {
-            handles_[c->getIndex()] = heap_.push(c);
+        (const cell_t & c) {
+            handles_[c.getIndex()] = heap_.push(FMHeapEntry(c.getTotalValue(), c.getIndex()));
         }
 
         /** \brief Pops index of the element with lowest value and removes it from the heap. */
-        unsigned int popMinIdx
+        size_t popMinIdx
         () {
-            const unsigned int idx = heap_.top()->getIndex();
+            const size_t idx = heap_.top().idx;
             heap_.pop();
             return idx;
         }
@@ -68,16 +71,16 @@ template <class cell_t = FMCell> class FMFibHeap {
 
         /** \brief Updates the position of the cell in the heap. Its priority can increase or decrease. */
         void update
-        (const cell_t * c) {
-            heap_.update(handles_[c->getIndex()], c);
+        (const cell_t & c) {
+            heap_.update(handles_[c.getIndex()], FMHeapEntry(c.getTotalValue(), c.getIndex()));
         }
 
         /** \brief Updates the position of the cell in the heap. Its priority can only increase.
             It is more efficient than the update() function if it is ensured that the priority
             will increase. */
         void increase
-        (const cell_t * c) {
-            heap_.increase(handles_[c->getIndex()],c);
+        (const cell_t & c) {
+            heap_.increase(handles_[c.getIndex()], FMHeapEntry(c.getTotalValue(), c.getIndex()));
         }
         
         /** \brief Deallocates heap memory. */
@@ -98,8 +101,9 @@ template <class cell_t = FMCell> class FMFibHeap {
         fib_heap_t heap_;  /*!< The actual heap for cell_t. */
         
         /** \brief Stores the handles of each cell by keeping the indices: handles_(0) is the handle for
-            the cell with index 0 in the grid. Makes possible to update the heap.*/
-        std::vector<handle_t> handles_;
+            the cell with index 0 in the grid. Makes possible to update the heap. Dense or paged, see
+            fmhandlestorage.hpp. */
+        storage_t<handle_t> handles_;
 };
 
 
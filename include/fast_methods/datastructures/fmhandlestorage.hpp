@@ -0,0 +1,109 @@
+/*! \file fmhandlestorage.hpp
+    \brief Storage policies for the per cell handles of the heaps (FMDaryHeap, FMFibHeap),
+    given as their second template parameter.
+
+    - FMDenseStorage: a vector with a handle per grid cell, default.
+    - FMPagedStorage: pages of handles allocated only when a cell in them is pushed. Pages are
+      kept by clear(), so that the memory is allocated once for all the runs of a solver.
+
+    A storage policy is a class template on the handle type with resize(n) (n cells in the
+    grid), operator[](idx) (the handle of cell idx, created if needed) and clear().
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FMHANDLESTORAGE_HPP_
+#define FMHANDLESTORAGE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/** \brief Handles of every cell of the grid in a vector: handles_[0] is the handle for
+    the cell with index 0 in the grid. */
+template <class T> class FMDenseStorage {
+    public:
+        /** \brief Allocates a handle for each of the n cells. */
+        void resize
+        (size_t n) {
+            handles_.resize(n);
+        }
+
+        /** \brief Returns the handle of cell idx. */
+        inline T & operator[]
+        (size_t idx) {
+            return handles_[idx];
+        }
+
+        /** \brief Removes all the handles (memory is not released, but resize() initializes
+            them again). */
+        void clear
+        () {
+            handles_.clear();
+        }
+
+    protected:
+        /** \brief Handles by cell index. */
+        std::vector<T> handles_;
+};
+
+/** \brief Handles in pages of 4096 consecutive cells, allocated the first time a handle in
+    them is accessed. Only the pages with cells pushed into the heap take memory, which is
+    much less than the whole grid in goal-directed queries (FMM*). Pages are released when
+    the storage is destroyed, not by clear(). */
+template <class T> class FMPagedStorage {
+
+    /** \brief Number of bits of the index within a page. */
+    static constexpr unsigned int pageBits = 12;
+
+    /** \brief Number of handles in a page. */
+    static constexpr size_t pageSize = size_t(1) << pageBits;
+
+    public:
+        /** \brief Sets the number of pages for n cells. Only a pointer per page is allocated. */
+        void resize
+        (size_t n) {
+            pages_.resize((n + pageSize - 1) >> pageBits);
+        }
+
+        /** \brief Returns the handle of cell idx, allocating its page if necessary. */
+        inline T & operator[]
+        (size_t idx) {
+            std::unique_ptr<T[]> & page = pages_[idx >> pageBits];
+            if (!page)
+                page.reset(new T[pageSize]);
+            return page[idx & (pageSize - 1)];
+        }
+
+        /** \brief Nothing to do: handles are only valid for the cells in the heap, so the
+            pages allocated are kept for the following runs. */
+        void clear
+        () {}
+
+        /** \brief Returns the number of pages allocated. */
+        size_t getAllocatedPages
+        () const {
+            size_t n = 0;
+            for (const std::unique_ptr<T[]> & p : pages_)
+                n += bool(p);
+            return n;
+        }
+
+    protected:
+        /** \brief Pages of handles, null if not allocated yet. */
+        std::vector<std::unique_ptr<T[]> > pages_;
+};
+
+#endif /* FMHANDLESTORAGE_HPP_ */
@@ -0,0 +1,170 @@
+/*! \class FMIndexedHeap
+    \brief Indexed D-ary min-heap for the FM algorithms, with the same interface as FMDaryHeap.
+
+    The elements (key and cell index, FMHeapEntry) are stored inline in a single array,
+    and the position of every cell in that array is kept in a flat array as big as the
+    grid. Therefore, there are no handles nor per element indirections: push(), pop and
+    increase() only move entries within the array and update the positions of the cells
+    moved. As in FMM the key of a cell in the narrow band can only decrease, increase()
+    only sifts up.
+
+    The arity D is a template parameter (2, 4 or 8): higher arities give shallower heaps,
+    less sift up steps and sift down steps which compare D contiguous entries.
+
+    IMPORTANT NOTE: positions are stored in 32 bits, so that the heap cannot contain more
+    than 2^32 elements at the same time (the grid can be bigger).
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FMINDEXEDHEAP_H_
+#define FMINDEXEDHEAP_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <fast_methods/datastructures/fmcompare.hpp>
+
+template <class cell_t = FMCell, unsigned int D = 4> class FMIndexedHeap {
+
+    static_assert(D >= 2, "FMIndexedHeap arity has to be 2 or higher.");
+
+    public:
+        FMIndexedHeap () {}
+
+        /** \brief Creates a heap with n maximum elements. */
+        FMIndexedHeap (const size_t & n) { positions_.resize(n); }
+
+        virtual ~ FMIndexedHeap() { clear(); }
+
+        /** \brief Sets the maximum number of cells the heap will contain. */
+        void setMaxSize
+        (const size_t & n) {
+            positions_.resize(n);
+        }
+
+        /** \brief Pushes a new element into the heap. */
+        void push
+        (const cell_t & c) {
+            heap_.push_back(FMHeapEntry(c.getTotalValue(), c.getIndex()));
+            siftUp(uint32_t(heap_.size() - 1));
+        }
+
+        /** \brief Pops index of the element with lowest value and removes it from the heap. */
+        size_t popMinIdx
+        () {
+            const size_t idx = heap_[0].idx;
+            const FMHeapEntry last = heap_.back();
+            heap_.pop_back();
+            if (!heap_.empty()) {
+                heap_[0] = last;
+                siftDown(0);
+            }
+            return idx;
+        }
+
+        /** \brief Returns current size of the heap. */
+        size_t size
+        () const {
+            return heap_.size();
+        }
+
+        /** \brief Updates the position of the cell in the heap. Its priority can increase or decrease. */
+        void update
+        (const cell_t & c) {
+            const uint32_t pos = positions_[c.getIndex()];
+            const double key = c.getTotalValue();
+            const bool up = key < heap_[pos].key;
+            heap_[pos].key = key;
+            if (up)
+                siftUp(pos);
+            else
+                siftDown(pos);
+        }
+
+        /** \brief Updates the position of the cell in the heap. Its priority can only increase
+            (its value decrease), so it is only sifted up. */
+        void increase
+        (const cell_t & c) {
+            const uint32_t pos = positions_[c.getIndex()];
+            heap_[pos].key = c.getTotalValue();
+            siftUp(pos);
+        }
+
+        /** \brief Deallocates heap memory. */
+        void clear
+        () {
+            heap_.clear();
+            positions_.clear();
+        }
+
+        /** \brief Returns true if the heap is empty. */
+        bool empty
+        () const {
+            return heap_.empty();
+        }
+
+    protected:
+        /** \brief Moves the entry in pos towards the root while its key is lower than the key
+            of its parent. The entries moved down and the one sifted are stored only once. */
+        inline void siftUp
+        (uint32_t pos) {
+            const FMHeapEntry e = heap_[pos];
+            while (pos > 0) {
+                const uint32_t parent = (pos - 1) / D;
+                if (!(e.key < heap_[parent].key))
+                    break;
+                heap_[pos] = heap_[parent];
+                positions_[heap_[pos].idx] = pos;
+                pos = parent;
+            }
+            heap_[pos] = e;
+            positions_[e.idx] = pos;
+        }
+
+        /** \brief Moves the entry in pos towards the leaves while the lowest key of its children
+            is lower than its key. */
+        inline void siftDown
+        (uint32_t pos) {
+            const FMHeapEntry e = heap_[pos];
+            const size_t n = heap_.size();
+            while (true) {
+                const size_t first = size_t(pos) * D + 1;
+                if (first >= n)
+                    break;
+                const size_t last = (first + D < n) ? first + D : n;
+                size_t best = first;
+                for (size_t c = first + 1; c < last; ++c)
+                    if (heap_[c].key < heap_[best].key)
+                        best = c;
+                if (!(heap_[best].key < e.key))
+                    break;
+                heap_[pos] = heap_[best];
+                positions_[heap_[pos].idx] = pos;
+                pos = uint32_t(best);
+            }
+            heap_[pos] = e;
+            positions_[e.idx] = pos;
+        }
+
+        /** \brief Entries of the heap, the children of entry i are D*i+1 ... D*i+D. */
+        std::vector<FMHeapEntry> heap_;
+
+        /** \brief Position in heap_ of each cell by its index: positions_[0] is the position of the
+            cell with index 0 in the grid. Only valid for the cells in the heap. */
+        std::vector<uint32_t> positions_;
+};
+
+#endif /* FMINDEXEDHEAP_H_ */
@@ -1,6 +1,12 @@
 /*! \class FMPriorityQueue
     \brief Wrap for the Boost Priority Queue class to be used in the FM 
     algorithms. Ready to be used with FMCell and derived types.
+
+    Keys cannot be modified in a priority queue: increase() pushes the cell again and the
+    old entries become stale. The last key pushed for every cell is kept in a flat array as
+    big as the grid, so that popMinIdx() discards the entries whose key is not the last one
+    of their cell (or whose cell was already popped) instead of returning the same cell
+    several times. The number of entries discarded is given by getStalePops().
     
     Copyright (C) 2014 Javier V. Gomez and Jose Pardeiro
     www.javiervgomez.com
@@ -20,6 +26,9 @@
 #ifndef FMPRIORITYQUEUE_H_
 #define FMPRIORITYQUEUE_H_
 
+#include <limits>
+#include <vector>
+
 #include <boost/heap/priority_queue.hpp>
 
 #include <fast_methods/datastructures/fmcompare.hpp>
@@ -27,61 +36,96 @@
 template <class cell_t = FMCell> class FMPriorityQueue{
 
     public:
-        FMPriorityQueue () {}
+        FMPriorityQueue () : size_(0), stalePops_(0) {}
 
-        /** \brief Shorthand for heap element handle type. */
-        FMPriorityQueue (const int & n) { heap_.reserve(n); }
+        /** \brief Creates a heap with n maximum elements. */
+        FMPriorityQueue (const size_t & n) : size_(0), stalePops_(0) {
+            heap_.reserve(n);
+            keys_.resize(n);
+        }
 
         virtual ~ FMPriorityQueue() {}
 
         /** \brief Sets the maximum number of cells the heap will contain. */
         void setMaxSize
-        (const int & n) {
+        (const size_t & n) {
             heap_.reserve(n);
+            keys_.resize(n);
         }
 
         /** \brief Pushes a new element into the heap. */
-        void push 
-        (const cell_t * c) {
-            heap_.push(c);
+        void push
+        (const cell_t & c) {
+            keys_[c.getIndex()] = c.getTotalValue();
+            heap_.push(FMHeapEntry(c.getTotalValue(), c.getIndex()));
+            ++size_;
         }
 
-        /** \brief Priority queues do not allow key increasing. Therefore, it pushes the element again.
-             This is done so that SFMM is implemented as FMM with this heap. */
+        /** \brief Priority queues do not allow key increasing. Therefore, it pushes the element again
+             and the previous entry of the cell becomes stale. This is done so that SFMM is implemented
+             as FMM with this heap. */
         void increase
-        (const cell_t * c) {
-            heap_.push(c);
+        (const cell_t & c) {
+            keys_[c.getIndex()] = c.getTotalValue();
+            heap_.push(FMHeapEntry(c.getTotalValue(), c.getIndex()));
         }
 
-        /** \brief Pops index of the element with lowest value and removes it from the heap. */ 
-        int popMinIdx
+        /** \brief Pops index of the element with lowest value and removes it from the heap.
+            Stale entries found on top are discarded first. */
+        size_t popMinIdx
         () {
-            const int idx = heap_.top()->getIndex();
+            while (heap_.top().key != keys_[heap_.top().idx]) {
+                heap_.pop();
+                ++stalePops_;
+            }
+            const size_t idx = heap_.top().idx;
             heap_.pop();
+            // The entries of this cell still in the heap are stale.
+            keys_[idx] = std::numeric_limits<double>::quiet_NaN();
+            --size_;
             return idx;
         }
 
-        /** \brief Returns current size of the heap. */
+        /** \brief Returns current size of the heap (number of cells, not counting stale entries). */
         size_t size
         () const {
-            return heap_.size();
+            return size_;
+        }
+
+        /** \brief Returns the number of stale entries discarded since the last clear(). */
+        size_t getStalePops
+        () const {
+            return stalePops_;
         }
 
         /** \brief Deallocates heap memory. */
         void clear
         () {
             heap_.clear();
+            keys_.clear();
+            size_ = 0;
+            stalePops_ = 0;
         }
 
-        /** \brief Returns true if the heap is empty. */
+        /** \brief Returns true if the heap is empty (there can be stale entries left). */
         bool empty
         () const {
-            return heap_.empty();
+            return size_ == 0;
         }
 
     protected:
         /** \brief The actual queue for FMCells. */
-        boost::heap::priority_queue<const cell_t *, boost::heap::compare<FMCompare<cell_t> > > heap_;
+        boost::heap::priority_queue<FMHeapEntry, boost::heap::compare<FMCompare> > heap_;
+
+        /** \brief Last key pushed for each cell by its index, NaN once the cell is popped. Only
+            valid for the cells pushed since the last clear(). */
+        std::vector<double> keys_;
+
+        /** \brief Number of cells in the heap. */
+        size_t size_;
+
+        /** \brief Number of stale entries discarded by popMinIdx(). */
+        size_t stalePops_;
 };
 
 
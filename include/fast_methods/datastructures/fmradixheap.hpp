@@ -0,0 +1,215 @@
+/*! \class FMRadixHeap
+    \brief Radix heap for the FM algorithms, with the same interface as FMDaryHeap.
+
+    A radix heap is a monotone priority queue: the keys pushed cannot be lower than the
+    last key popped, which is the case of FMM (cells are accepted in non-decreasing order of
+    arrival time). Keys are mapped to 64-bit integers preserving their order (the bits of
+    positive doubles are already ordered), and the elements are kept in 65 buckets: bucket
+    0 holds the elements with the same key as the last popped one and bucket i > 0 those
+    whose key first differs from it in bit i-1. Popping from an empty bucket 0 finds the
+    minimum of the first non-empty bucket and redistributes that bucket into lower ones.
+    Every element moves at most 64 times, so push, increase and pop are amortized O(1)
+    (for a fixed key size), without comparisons between elements.
+
+    The position of every cell (bucket and position in it) is kept in a flat array as big
+    as the grid, so that increase() moves the cell to its new bucket in O(1).
+
+    IMPORTANT NOTE: keys lower than the last popped one are popped as if they had the key
+    of the last popped one. In FMM this only happens by rounding errors, but the heuristic
+    values of FMM* are not consistent and its keys decrease often: do not use this heap with
+    heuristics, the results would be wrong.
+
+    @par External documentation:
+        R.K. Ahuja, K. Mehlhorn, J. Orlin and R.E. Tarjan, Faster algorithms for the shortest
+        path problem, Journal of the ACM, 37(2), 213-223, 1990.
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FMRADIXHEAP_H_
+#define FMRADIXHEAP_H_
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <fast_methods/ndgridmap/fmcell.h>
+
+template <class cell_t = FMCell> class FMRadixHeap {
+
+    /** \brief Element of the buckets: integer key and cell index. */
+    struct Entry {
+        uint64_t key;
+        size_t idx;
+    };
+
+    /** \brief Position of a cell in the heap. */
+    struct Location {
+        uint32_t pos;
+        uint32_t bucket;
+    };
+
+    /** \brief Number of buckets: one per bit of the keys plus bucket 0. */
+    static constexpr unsigned int nbuckets = 65;
+
+    public:
+        FMRadixHeap () : last_(0), size_(0) {}
+
+        /** \brief Creates a heap with n maximum elements. */
+        FMRadixHeap (const size_t & n) : last_(0), size_(0) { locations_.resize(n); }
+
+        virtual ~ FMRadixHeap() { clear(); }
+
+        /** \brief Sets the maximum number of cells the heap will contain. */
+        void setMaxSize
+        (const size_t & n) {
+            locations_.resize(n);
+        }
+
+        /** \brief Pushes a new element into the heap. */
+        void push
+        (const cell_t & c) {
+            insert(toKey(c.getTotalValue()), c.getIndex());
+            ++size_;
+        }
+
+        /** \brief Pops index of the element with lowest value and removes it from the heap. */
+        size_t popMinIdx
+        () {
+            if (buckets_[0].empty())
+                redistribute();
+            const size_t idx = buckets_[0].back().idx;
+            buckets_[0].pop_back();
+            --size_;
+            return idx;
+        }
+
+        /** \brief Returns current size of the heap. */
+        size_t size
+        () const {
+            return size_;
+        }
+
+        /** \brief Updates the position of the cell in the heap. Its priority can increase or
+            decrease: the cell is moved to the bucket of its new key. */
+        void update
+        (const cell_t & c) {
+            remove(c.getIndex());
+            insert(toKey(c.getTotalValue()), c.getIndex());
+        }
+
+        /** \brief Updates the position of the cell in the heap. Its priority can only increase. */
+        void increase
+        (const cell_t & c) {
+            update(c);
+        }
+
+        /** \brief Deallocates heap memory. */
+        void clear
+        () {
+            for (std::vector<Entry> & b : buckets_)
+                b.clear();
+            locations_.clear();
+            last_ = 0;
+            size_ = 0;
+        }
+
+        /** \brief Returns true if the heap is empty. */
+        bool empty
+        () const {
+            return size_ == 0;
+        }
+
+    protected:
+        /** \brief Maps a double to an integer with the same order: sign bit set for positive
+            numbers, all the bits flipped for negative ones. */
+        static inline uint64_t toKey
+        (double v) {
+            uint64_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            return (bits >> 63) ? ~bits : bits | (uint64_t(1) << 63);
+        }
+
+        /** \brief Returns the bucket of key: 0 if it is the last popped key, otherwise one
+            plus the highest bit in which they differ. */
+        inline unsigned int bucketOf
+        (uint64_t key) const {
+            return (key == last_) ? 0 : 64 - __builtin_clzll(key ^ last_);
+        }
+
+        /** \brief Inserts the cell idx with key in its bucket. Keys lower than last_ are
+            raised to it (see class description). */
+        inline void insert
+        (uint64_t key, size_t idx) {
+            if (key < last_)
+                key = last_;
+            const unsigned int b = bucketOf(key);
+            locations_[idx].pos = uint32_t(buckets_[b].size());
+            locations_[idx].bucket = b;
+            buckets_[b].push_back({key, idx});
+        }
+
+        /** \brief Removes the cell idx from its bucket, moving the last element of the bucket
+            to its position. */
+        inline void remove
+        (size_t idx) {
+            const Location l = locations_[idx];
+            std::vector<Entry> & b = buckets_[l.bucket];
+            b[l.pos] = b.back();
+            locations_[b[l.pos].idx].pos = l.pos;
+            b.pop_back();
+        }
+
+        /** \brief Sets last_ to the minimum key of the first non-empty bucket and moves all its
+            elements to lower buckets, at least one of them to bucket 0. The heap must not be
+            empty. */
+        void redistribute
+        () {
+            unsigned int i = 1;
+            while (buckets_[i].empty())
+                ++i;
+
+            std::vector<Entry> & b = buckets_[i];
+            uint64_t min = b[0].key;
+            for (const Entry & e : b)
+                if (e.key < min)
+                    min = e.key;
+            last_ = min;
+
+            for (const Entry & e : b) {
+                const unsigned int nb = bucketOf(e.key);
+                locations_[e.idx].pos = uint32_t(buckets_[nb].size());
+                locations_[e.idx].bucket = nb;
+                buckets_[nb].push_back(e);
+            }
+            b.clear();
+        }
+
+        /** \brief Buckets of elements, see class description. */
+        std::array<std::vector<Entry>, nbuckets> buckets_;
+
+        /** \brief Bucket and position in it of each cell by its index. Only valid for the cells
+            in the heap. */
+        std::vector<Location> locations_;
+
+        /** \brief Last key popped (the minimum of the heap). */
+        uint64_t last_;
+
+        /** \brief Number of elements in the heap. */
+        size_t size_;
+};
+
+#endif /* FMRADIXHEAP_H_ */
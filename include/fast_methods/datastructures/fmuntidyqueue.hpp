@@ -1,7 +1,24 @@
 /*! \class FMUntidyQueue
-    \brief Wraps the UntidyQueue implementation by 
+    \brief Untidy priority queue for the UFMM, based on the implementation by
     [Jerome Piovano](ftp://ftp-sop.inria.fr/athena/Team/Jerome.Piovano/Doxygen/classlevelset_1_1PriorityQueue.html)
-    
+
+    The arrival times are quantized in s buckets of width inc/s, arranged as a circular
+    array: the first bucket (i0_) holds the times in [t0_, t0_ + inc/s). Cells are popped in
+    the order they were pushed into the first non-empty bucket, so the order of the cells
+    inside a bucket is not sorted (untidy). All the operations are O(1).
+
+    Every bucket is a contiguous vector of cell indices and the position of every cell in
+    its bucket is kept in a flat array as big as the grid. Therefore, increase() removes the
+    cell from its bucket in O(1), moving the last cell of the bucket to its position. Popped
+    cells are not erased: the bucket is only emptied (keeping its memory) once all its cells
+    are popped.
+
+    IMPORTANT NOTE: times lower than t0_ are stored in the first bucket, and times higher than
+    t0_ + inc in the last one. In FMM the first case only happens by rounding errors. To avoid
+    the second one, inc has to be higher than the maximum difference between the arrival
+    times of the narrow band (the leaf size times the maximum slowness is enough), or the
+    queue has to be adaptive (see setAdaptive()).
+
     Copyright (C) 2014 Javier V. Gomez
     www.javiervgomez.com
 
@@ -20,67 +37,255 @@
 #ifndef FMUNTIDYQUEUE_HPP_
 #define FMUNTIDYQUEUE_HPP_
 
-#include <fast_methods/thirdparty/untidy_queue.hpp>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include <fast_methods/ndgridmap/fmcell.h>
 
-/// \todo save buckets here as a hash table instead of saving them in FMCell.
 template<class cell_t = FMCell> class FMUntidyQueue {
 
+    /** \brief Shorthand for the index type of the cells. */
+    typedef typename cell_t::index_t index_t;
+
+    /** \brief Cells in a bucket, in the order they were pushed. The cells before head are
+        already popped. */
+    struct Bucket {
+        std::vector<index_t> cells;
+        size_t head;
+    };
+
     public:
-        /** \brief Creates an object with s buckets of size s. */
+        /** \brief Creates an object with s buckets for a maximum increment inc. */
         FMUntidyQueue
-        (unsigned s = 1000, double inc = 2) {
-            queue_ = new levelset::PriorityQueue<const cell_t * >(s, inc);
+        (unsigned s = 1000, double inc = 2) :
+        buckets_(s, Bucket{std::vector<index_t>(), 0}),
+        inc_(inc),
+        delta_(inc/s),
+        t0_(0),
+        i0_(0),
+        size_(0),
+        adaptive_(false) {}
+
+        virtual ~FMUntidyQueue() {}
+
+        /** \brief Sets the maximum number of cells the heap will contain. */
+        void setMaxSize
+        (const size_t & n) {
+            locations_.resize(n);
+        }
+
+        /** \brief Sets s buckets for a maximum increment inc. The heap is emptied. */
+        void setBuckets
+        (unsigned s, double inc) {
+            clear();
+            buckets_.resize(s, Bucket{std::vector<index_t>(), 0});
+            inc_ = inc;
+            delta_ = inc/s;
         }
 
-        virtual ~FMUntidyQueue() { delete queue_; }
+        /** \brief If true, the number of buckets grows (keeping their width) when a time higher
+            than the maximum increment is pushed, instead of storing it in the last bucket. False
+            by default. */
+        void setAdaptive
+        (bool a) {
+            adaptive_ = a;
+        }
+
+        /** \brief Returns true if the queue is adaptive. */
+        bool isAdaptive
+        () const {
+            return adaptive_;
+        }
+
+        /** \brief Returns the current number of buckets. */
+        unsigned getNBuckets
+        () const {
+            return unsigned(buckets_.size());
+        }
+
+        /** \brief Returns the current maximum increment. */
+        double getMaxIncrement
+        () const {
+            return inc_;
+        }
 
         /** \brief Pushes a new element into the heap. */
         void push
-        (cell_t * c) {
-            c->setBucket( queue_->push(c, c->getArrivalTime()) );
+        (const cell_t & c) {
+            if (empty()) {
+                t0_ = c.getArrivalTime();
+                i0_ = 0;
+            }
+            insert(c.getIndex(), fit(c.getArrivalTime()));
+            ++size_;
         }
 
         /** \brief Returns current size of the heap. */
         size_t size
         () const {
-            return queue_->size();
+            return size_;
         }
 
         /** \brief Updates the position of the cell in the priority queue. Its priority can only increase.
-             Also updates the bucket of the cell. */
+             The cell is moved only if its bucket changes. */
         void increase
-        (cell_t * c) {
-            c->setBucket( queue_->increase_priority(c, c->getBucket(), c->getArrivalTime()) );
+        (const cell_t & c) {
+            const unsigned int b = fit(c.getArrivalTime());
+            if (b == locations_[c.getIndex()].bucket)
+                return;
+            remove(c.getIndex());
+            insert(c.getIndex(), b);
         }
 
         /** \brief Returns index of the element with \e lowest value (to be popped next). */
-        unsigned int topIdx
+        index_t topIdx
         (){
-            return queue_->top()->getIndex();
+            advance();
+            const Bucket & b = buckets_[i0_];
+            return b.cells[b.head];
         }
 
         /** \brief Removes the top value of the heap. */
         void pop
         () {
-            queue_->pop();
+            if (empty())
+                return;
+            advance();
+            Bucket & b = buckets_[i0_];
+            if (++b.head == b.cells.size()) {
+                b.cells.clear();
+                b.head = 0;
+            }
+            --size_;
         }
 
-        /** \brief Deallocates heap memory. */
+        /** \brief Empties the heap. The memory of the buckets is kept. */
         void clear
         () {
-            queue_->clear();
+            for (Bucket & b : buckets_) {
+                b.cells.clear();
+                b.head = 0;
+            }
+            t0_ = 0;
+            i0_ = 0;
+            size_ = 0;
         }
 
         /** \brief Returns true if the heap is empty. */
         bool empty
         () const {
-            return queue_->empty();
+            return size_ == 0;
         }
 
     protected:
-        /** \brief The actual Unitidy queue for cell_t. */
-        levelset::PriorityQueue<const cell_t * > * queue_;
+        /** \brief Position of a cell in the heap. */
+        struct Location {
+            uint32_t bucket;
+            uint32_t pos;
+        };
+
+        /** \brief Returns the bucket of time t in the circular array. Times out of
+            [t0_, t0_ + inc_) go to the first or the last bucket (see class description). */
+        inline unsigned int bucketOf
+        (double t) const {
+            const unsigned int s = unsigned(buckets_.size());
+            const double offset = std::floor((t - t0_) * s / inc_);
+            unsigned int i = 0;
+            if (offset >= s)
+                i = s - 1;
+            else if (offset > 0)
+                i = unsigned(offset);
+            i += i0_;
+            return (i >= s) ? i - s : i;
+        }
+
+        /** \brief Returns the bucket of time t, first adding buckets if the queue is adaptive
+            and t is out of range. */
+        inline unsigned int fit
+        (double t) {
+            if (adaptive_ && t - t0_ >= inc_)
+                grow(t);
+            return bucketOf(t);
+        }
+
+        /** \brief Adds buckets of the same width, at least doubling their number, so that
+            t is in range. The circular array is unrolled starting at i0_, so that the relative
+            position of the buckets (their times) does not change. */
+        void grow
+        (double t) {
+            const unsigned int s = unsigned(buckets_.size());
+            unsigned int news = 2*s;
+            while ((t - t0_) * s / inc_ >= news)
+                news *= 2;
+
+            std::vector<Bucket> buckets(news, Bucket{std::vector<index_t>(), 0});
+            for (unsigned int k = 0; k < s; ++k) {
+                Bucket & b = buckets[k];
+                std::swap(b, buckets_[(i0_ + k) % s]);
+                for (size_t p = b.head; p < b.cells.size(); ++p)
+                    locations_[b.cells[p]].bucket = k;
+            }
+            buckets_.swap(buckets);
+            i0_ = 0;
+            inc_ = delta_ * news;
+        }
+
+        /** \brief Moves i0_ (and t0_) to the first non-empty bucket. The heap must not be empty. */
+        inline void advance
+        () {
+            while (buckets_[i0_].head == buckets_[i0_].cells.size()) {
+                if (++i0_ == buckets_.size())
+                    i0_ = 0;
+                t0_ += delta_;
+            }
+        }
+
+        /** \brief Appends the cell idx to bucket b. */
+        inline void insert
+        (index_t idx, unsigned int b) {
+            std::vector<index_t> & cells = buckets_[b].cells;
+            locations_[idx] = {b, uint32_t(cells.size())};
+            cells.push_back(idx);
+        }
+
+        /** \brief Removes the cell idx from its bucket, moving the last cell of the bucket to
+            its position. The cell cannot be popped already. */
+        inline void remove
+        (index_t idx) {
+            const Location l = locations_[idx];
+            std::vector<index_t> & cells = buckets_[l.bucket].cells;
+            const index_t last = cells.back();
+            cells[l.pos] = last;
+            locations_[last].pos = l.pos;
+            cells.pop_back();
+        }
+
+        /** \brief Circular array of buckets. */
+        std::vector<Bucket> buckets_;
+
+        /** \brief Bucket and position in it of each cell by its index. Only valid for the cells
+            in the heap. */
+        std::vector<Location> locations_;
+
+        /** \brief Maximum increment of the times in the heap. */
+        double inc_;
+
+        /** \brief Width of each bucket, inc_/s. */
+        double delta_;
+
+        /** \brief Lowest time of the first bucket. */
+        double t0_;
+
+        /** \brief Position of the first bucket in the circular array. */
+        unsigned int i0_;
+
+        /** \brief Number of elements in the heap. */
+        size_t size_;
+
+        /** \brief If true, buckets are added when needed (see setAdaptive()). */
+        bool adaptive_;
 };
 
 #endif /* FMUNTIDYQUEUE_H_ */
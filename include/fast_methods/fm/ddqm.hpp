@@ -41,6 +41,10 @@
 template < class grid_t > class DDQM : public EikonalSolver<grid_t> {
 
     public:
+        typedef typename EikonalSolver<grid_t>::index_t index_t;
+        typedef typename EikonalSolver<grid_t>::value_t value_t;
+        using EikonalSolver<grid_t>::setEnvironment;
+
         DDQM(const char * name = "DDQM") : EikonalSolver<grid_t>(name) {}
 
         /** \brief Calls EikonalSolver::setEnvironment() and sets the initial threshold. */
@@ -55,7 +59,7 @@ template < class grid_t > class DDQM : public EikonalSolver<grid_t> {
         virtual void setup
         () {
             EikonalSolver<grid_t>::setup();
-            if (int(goal_idx_) != -1)
+            if (goal_idx_ != index_t(-1))
                 console::warning("Setting a goal point in DDQM is experimental. It may lead to wrong results.");
         }
 
@@ -70,17 +74,17 @@ template < class grid_t > class DDQM : public EikonalSolver<grid_t> {
             // setEnvironment it can affect other planners run in the same
             // grid.
             for(size_t i = 0; i < grid_->size(); ++i)
-                grid_->getCell(i).setState(FMState::FROZEN);
+                (*grid_)[i].setState(FMState::FROZEN);
 
             // Initialization
             unsigned int n_neighs = 0;
-            for (unsigned int i: init_points_) {
-                grid_->getCell(i).setArrivalTime(0);
+            for (index_t i: init_points_) {
+                (*grid_)[i].setArrivalTime(0);
                 n_neighs = grid_->getNeighbors(i, neighbors_);
                 for (unsigned int j = 0; j < n_neighs; ++j) {
-                    if (grid_->getCell(neighbors_[j]).isOccupied())
+                    if ((*grid_)[neighbors_[j]].isOccupied())
                         continue;
-                    grid_->getCell(neighbors_[j]).setState(FMState::OPEN);
+                    (*grid_)[neighbors_[j]].setState(FMState::OPEN);
                     queues_[0].push(neighbors_[j]);
                 }
             }
@@ -94,19 +98,21 @@ template < class grid_t > class DDQM : public EikonalSolver<grid_t> {
 
             while ((!queues_[0].empty() || !queues_[1].empty()) && !stopPropagation) {
                 while (!queues_[lq].empty() && !stopPropagation) {
-                    unsigned int idx = queues_[lq].front();
+                    index_t idx = queues_[lq].front();
                     queues_[lq].pop();
-                    if (grid_->getCell(idx).isOccupied())
+                    if ((*grid_)[idx].isOccupied())
                         continue;
                     double newT = solveEikonal(idx);
-                    if (utils::isTimeBetterThan(newT, grid_->getCell(idx).getArrivalTime())) {
-                        grid_->getCell(idx).setArrivalTime(newT);
+                    if (utils::isTimeBetterThan<value_t>(newT, (*grid_)[idx].getArrivalTime())) {
+                        (*grid_)[idx].setArrivalTime(newT);
                         n_neighs = grid_->getNeighbors(idx, neighbors_);
                         for (unsigned int j = 0; j < n_neighs; ++j) {
-                            unsigned int n = neighbors_[j];
-                            if (grid_->getCell(n).getState() == FMState::FROZEN) // In the paper they say unlocked here, but makes no sense!!
-                                if(utils::isTimeBetterThan(newT, grid_->getCell(n).getArrivalTime())) {
-                                    grid_->getCell(n).setState(FMState::OPEN);
+                            index_t n = neighbors_[j];
+                            if ((*grid_)[n].isOccupied())
+                                continue;
+                            if ((*grid_)[n].getState() == FMState::FROZEN) // In the paper they say unlocked here, but makes no sense!!
+                                if(utils::isTimeBetterThan<value_t>(newT, (*grid_)[n].getArrivalTime())) {
+                                    (*grid_)[n].setState(FMState::OPEN);
                                     counts[1] += 1;
                                     if (utils::isTimeBetterThan(newT, threshold_)) {
                                         queues_[lq].push(n); // Insert in lower queue.
@@ -117,7 +123,7 @@ template < class grid_t > class DDQM : public EikonalSolver<grid_t> {
                                 }
                         }
                     } // If time is improved.
-                    grid_->getCell(idx).setState(FMState::FROZEN);
+                    (*grid_)[idx].setState(FMState::FROZEN);
                     // EXPERIMENTAL - Value not updated, it has converged
                     if(idx == goal_idx_)
                         stopPropagation = true;
@@ -179,7 +185,7 @@ template < class grid_t > class DDQM : public EikonalSolver<grid_t> {
         using EikonalSolver<grid_t>::neighbors_;
 
         /** \brief Queues which contain the lower and higher cells to be expanded in further iterations. */
-        std::array<std::queue<unsigned int>, 2> queues_;
+        std::array<std::queue<index_t>, 2> queues_;
 
         /** \brief Current queue cutoff to divide lower and higher queues. */
         double threshold_;
@@ -5,6 +5,19 @@
     It uses as a main container the nDGridMap class. The nDGridMap template paramenter
     has to be an FMCell or something inherited from it.
 
+    Optionally (setFactored()), the factored Eikonal equation is solved instead: T = T0 tau,
+    being T0 the arrival time from the closest initial point with the velocity of that point
+    and tau the unknown. T0 carries the singularity of T at the initial point, and tau is
+    smooth there, so that the first order error of the solvers does not grow close to the
+    sources. In homogeneous media tau = 1 and the solution is exact.
+
+    @par External documentation:
+        S. Fomel, S. Luo and H. Zhao, Fast sweeping method for the factored eikonal equation,
+        Journal of Computational Physics, 228(17), 6440-6455, 2009.
+
+        E. Treister and E. Haber, A fast marching algorithm for the factored eikonal equation,
+        Journal of Computational Physics, 324, 210-225, 2016.
+
     Copyright (C) 2015 Javier V. Gomez
     www.javiervgomez.com
 
@@ -30,43 +43,318 @@
 #include <fstream>
 #include <array>
 #include <chrono>
+#include <limits>
+#include <vector>
 
 #include <boost/concept_check.hpp>
 
 #include <fast_methods/fm/solver.hpp>
+#include <fast_methods/ndgridmap/fmcell.h>
 #include <fast_methods/console/console.h>
 
 template <class grid_t>
 class EikonalSolver : public Solver<grid_t>{
 
     public:
-        EikonalSolver() : Solver<grid_t>("EikonalSolver") {}
-        EikonalSolver(const std::string& name) : Solver<grid_t>(name) {}
+        typedef typename Solver<grid_t>::index_t index_t;
+        typedef typename Solver<grid_t>::value_t value_t;
+
+        EikonalSolver() : Solver<grid_t>("EikonalSolver"), factored_(false),
+            factoredRadius_(std::numeric_limits<double>::infinity()) {}
+        EikonalSolver(const std::string& name) : Solver<grid_t>(name), factored_(false),
+            factoredRadius_(std::numeric_limits<double>::infinity()) {}
+
+        /** \brief Solves the factored Eikonal equation (see class description) for the cells
+            closer than radius cells to an initial point, the whole grid by default. Taken into
+            account in the next setup(). */
+        void setFactored
+        (bool factored, double radius = std::numeric_limits<double>::infinity()) {
+            factored_ = factored;
+            factoredRadius_ = radius;
+        }
+
+        /** \brief Returns true if the factored Eikonal equation is solved. */
+        bool isFactored
+        () const {
+            return factored_;
+        }
+
+        /** \brief Executes Solver setup and, for the factored Eikonal equation, stores the
+            coordinates and slowness of the initial points. */
+        virtual void setup
+        () {
+            Solver<grid_t>::setup();
+            sources_.clear();
+            if (!factored_)
+                return;
+            for (index_t i : init_points_) {
+                Source s;
+                grid_->idx2coord(i, s.coords);
+                s.slowness = 1 / (*grid_)[i].getVelocity();
+                sources_.push_back(s);
+            }
+        }
 
         /** \brief Solves nD Eikonal equation for cell idx. If heuristics are activated, it will add
             the estimated travel time to goal with current velocity. */
         virtual double solveEikonal
-        (const int & idx) {
-            unsigned int a = grid_t::getNDims(); // a parameter of the Eikonal equation.
-            Tvalues_.clear();
+        (index_t idx) {
+            double factoredT;
+            if (factored_ && solveFactoredEikonal(idx, factoredT))
+                return factoredT;
+
+            unsigned int a = 0; // a parameter of the Eikonal equation.
+            const double T = (*grid_)[idx].getArrivalTime();
 
             for (unsigned int dim = 0; dim < grid_t::getNDims(); ++dim) {
                 double minTInDim = grid_->getMinValueInDim(idx, dim);
-                if (!std::isinf(minTInDim) && minTInDim < grid_->getCell(idx).getArrivalTime())
-                    Tvalues_.push_back(minTInDim);
-                else
-                    a -=1;
+                if (!std::isinf(minTInDim) && minTInDim < T)
+                    Tvalues_[a++] = minTInDim;
             }
 
             if (a == 0)
                 return std::numeric_limits<double>::infinity();
 
+            // Time to cross the cell, and its square, computed once for all the dimensions.
+            double t, tt;
+            getCrossingTimes(idx, t, tt);
+            return solveEikonalTValues(a, t, tt);
+        }
+
+        /** \brief Solves the Eikonal equation for the neighbors of cell idx which are not frozen
+            nor occupied, those FMM-like solvers update after accepting idx. Stores their indices
+            in neighbors_ and their solutions in neighborTimes_, in the order given by
+            nDGridMap::getNeighbors(), and returns how many they are.
+
+            Same results as solveEikonal() for each neighbor, but the neighborhood of idx is
+            visited once: the coordinates of idx give the bounds of all the neighbors, and their
+            neighbor values are read straight from the grid, without computing and storing
+            their neighbors per dimension (nDGridMap::getMinValueInDim()). Solvers
+            which modify solveEikonal() have to use solveNeighborsByCell() instead. */
+        virtual unsigned int solveNeighbors
+        (index_t idx) {
+            if (factored_)
+                return solveNeighborsByCell(idx);
+
+            constexpr size_t N = grid_t::getNDims();
+            const double inf = std::numeric_limits<double>::infinity();
+            const double Tidx = (*grid_)[idx].getArrivalTime();
+            const std::array<unsigned int, N> dimsize = grid_->getDimSizes();
+            std::array<unsigned int, N> coords;
+            grid_->idx2coord(idx, coords);
+
+            // Cells at one (in[d][dir]) and two (in2[d][dir]) steps from idx in dimension d exist.
+            std::array<std::array<bool, 2>, N> in, in2;
+            for (unsigned int d = 0; d < N; ++d) {
+                in[d][0] = coords[d] >= 1;
+                in[d][1] = coords[d] + 1 < dimsize[d];
+                in2[d][0] = coords[d] >= 2;
+                in2[d][1] = coords[d] + 2 < dimsize[d];
+            }
+
+            unsigned int n = 0;
+            for (unsigned int dim = 0; dim < N; ++dim)
+                for (int dir = -1; dir <= 1; dir += 2) {
+                    if (!in[dim][dir > 0])
+                        continue;
+                    const index_t j = grid_->step(idx, dim, dir);
+                    if ((*grid_)[j].getState() == FMState::FROZEN || (*grid_)[j].isOccupied())
+                        continue;
+                    const double T = (*grid_)[j].getArrivalTime();
+
+                    unsigned int a = 0;
+                    for (unsigned int d = 0; d < N; ++d) {
+                        // In the dimension of the step: idx and the next cell in the same direction.
+                        // In the others, the cells diagonal to idx.
+                        double minTInDim = (d == dim) ? Tidx : inf;
+                        if (d == dim) {
+                            if (in2[d][dir > 0])
+                                minTInDim = std::min(minTInDim, double((*grid_)[grid_->step(j, d, dir)].getArrivalTime()));
+                        }
+                        else {
+                            if (in[d][0])
+                                minTInDim = std::min(minTInDim, double((*grid_)[grid_->step(j, d, -1)].getArrivalTime()));
+                            if (in[d][1])
+                                minTInDim = std::min(minTInDim, double((*grid_)[grid_->step(j, d, 1)].getArrivalTime()));
+                        }
+                        if (!std::isinf(minTInDim) && minTInDim < T)
+                            Tvalues_[a++] = minTInDim;
+                    }
+
+                    neighbors_[n] = j;
+                    if (a == 0)
+                        neighborTimes_[n++] = inf;
+                    else {
+                        double t, tt;
+                        getCrossingTimes(j, t, tt);
+                        neighborTimes_[n++] = solveEikonalTValues(a, t, tt);
+                    }
+                }
+            return n;
+        }
+
+    protected:
+        /** \brief As solveNeighbors(), calling solveEikonal() for every neighbor. */
+        unsigned int solveNeighborsByCell
+        (index_t idx) {
+            std::array<index_t, 2*grid_t::getNDims()> neighs;
+            const unsigned int n_neighs = grid_->getNeighbors(idx, neighs);
+            unsigned int n = 0;
+            for (unsigned int s = 0; s < n_neighs; ++s) {
+                const index_t j = neighs[s];
+                if ((*grid_)[j].getState() == FMState::FROZEN || (*grid_)[j].isOccupied())
+                    continue;
+                neighbors_[n] = j;
+                neighborTimes_[n++] = solveEikonal(j);
+            }
+            return n;
+        }
+
+        /** \brief Initial point of the factored Eikonal equation. */
+        struct Source {
+            /** \brief Coordinates of the initial point. */
+            std::array<unsigned int, grid_t::getNDims()> coords;
+
+            /** \brief Inverse of the velocity in the initial point. */
+            double slowness;
+        };
+
+        /** \brief Solves the factored Eikonal equation for cell idx, with first order upwind
+            differences for tau:
+
+                sum_d (a_d tau - T0 tau_d)^2 = (leafsize/velocity)^2,   a_d = T0 -+ leafsize dT0/dx_d
+
+            being tau_d = T_d/T0_d the value of the upwind neighbor in dimension d. Dimensions are
+            added in increasing order of T_d, as in the first order scheme. Returns false if
+            idx is farther than the factored radius from every initial point or the solution is
+            not upwind, so that the first order scheme is used instead. */
+        bool solveFactoredEikonal
+        (index_t idx, double & updatedT) const {
+            constexpr size_t N = grid_t::getNDims();
+            const double T = (*grid_)[idx].getArrivalTime();
+            const double leafsize = grid_->getLeafSize();
+            const std::array<unsigned int, N> dimsize = grid_->getDimSizes();
+            std::array<unsigned int, N> coords;
+            grid_->idx2coord(idx, coords);
+
+            // T0 given by the closest initial point (in time).
+            const Source * src = nullptr;
+            double T0 = std::numeric_limits<double>::infinity();
+            double dist = 0;
+            for (const Source & s : sources_) {
+                const double d = distance(coords, s.coords);
+                if (s.slowness * d < T0) {
+                    T0 = s.slowness * d;
+                    dist = d;
+                    src = &s;
+                }
+            }
+            if (!src || dist > factoredRadius_)
+                return false;
+            T0 *= leafsize;
+
+            // Upwind neighbor of each dimension: T_d, a_d and b_d = T0 tau_d, sorted by T_d.
+            std::array<std::array<double, 3>, N> terms;
+            std::array<unsigned int, N> nbCoords = coords;
+            unsigned int n = 0;
+            for (unsigned int dim = 0; dim < N; ++dim) {
+                double Td = std::numeric_limits<double>::infinity();
+                int dird = 0;
+                for (int dir = -1; dir <= 1; dir += 2) {
+                    if ((dir < 0 && coords[dim] == 0) || (dir > 0 && coords[dim] + 1 >= dimsize[dim]))
+                        continue;
+                    const double Tn = (*grid_)[grid_->step(idx, dim, dir)].getArrivalTime();
+                    if (Tn < Td) {
+                        Td = Tn;
+                        dird = dir;
+                    }
+                }
+                if (!(Td < T))
+                    continue;
+
+                nbCoords[dim] = coords[dim] + dird;
+                const double T0d = src->slowness * leafsize * distance(nbCoords, src->coords);
+                nbCoords[dim] = coords[dim];
+                const double taud = T0d > 0 ? Td/T0d : 1;
+                const double gradT0 = src->slowness * (double(coords[dim]) - double(src->coords[dim])) / dist;
+
+                unsigned int i = n++;
+                for (; i > 0 && terms[i-1][0] > Td; --i)
+                    terms[i] = terms[i-1];
+                terms[i] = {{Td, T0 - dird * leafsize * gradT0, T0 * taud}};
+            }
+            if (n == 0)
+                return false;
+
+            double t, tt;
+            getCrossingTimes(idx, t, tt);
+
+            double A = 0, B = 0, C = 0;
+            double tau = std::numeric_limits<double>::infinity();
+            unsigned int used = 0;
+            for (unsigned int i = 0; i < n; ++i) {
+                A += terms[i][1] * terms[i][1];
+                B += terms[i][1] * terms[i][2];
+                C += terms[i][2] * terms[i][2];
+                const double quad_term = B*B - A*(C - tt);
+                if (quad_term < 0)
+                    break;
+                tau = (B + std::sqrt(quad_term))/A;
+                used = i + 1;
+                if (i + 1 == n || T0 * tau <= terms[i+1][0])
+                    break;
+            }
+
+            updatedT = T0 * tau;
+            return used > 0 && updatedT >= terms[used-1][0] && !std::isinf(updatedT);
+        }
+
+        /** \brief Euclidean distance, in cells, between two coordinates. */
+        static double distance
+        (const std::array<unsigned int, grid_t::getNDims()> & c1,
+         const std::array<unsigned int, grid_t::getNDims()> & c2) {
+            double d2 = 0;
+            for (size_t i = 0; i < c1.size(); ++i) {
+                const double d = double(c1[i]) - double(c2[i]);
+                d2 += d*d;
+            }
+            return std::sqrt(d2);
+        }
+
+        /** \brief Returns in t the time to cross the cell idx (leafsize/velocity) and in tt its
+            square, precomputed if the grid keeps them (see nDGridMap::setPrecomputedSlowness()).
+            They are computed from the velocity if the slowness is outdated, for instance when
+            the solver is used before Solver::compute() updates it. */
+        inline void getCrossingTimes
+        (index_t idx, double & t, double & tt) const {
+            if (grid_->isSlownessUpdated()) {
+                const typename grid_t::Slowness & s = grid_->getSlowness(idx);
+                t = s.t;
+                tt = s.tt;
+                return;
+            }
+            const double leafsize = grid_->getLeafSize();
+            const double vel = (*grid_)[idx].getVelocity();
+            t = leafsize / vel;
+            tt = leafsize * leafsize / (vel*vel);
+        }
+
+        /** \brief Solves the Eikonal equation for the first a (> 0) elements of Tvalues_, the
+            minimum neighbor values lower than the current time of the cell in each dimension.
+            t is the time to cross the cell (leafsize/velocity) and tt its square. */
+        inline double solveEikonalTValues
+        (unsigned int a, double t, double tt) {
             // Sort the neighbor values to make easy the following code.
-            /// \todo given that this sorts a small vector, a n^2 methods could be better. Test it.
-            std::sort(Tvalues_.begin(), Tvalues_.end());
-            double updatedT;
+            sortTValues(a);
+            return solveSortedTValues(a, t, tt);
+        }
+
+        /** \brief As solveEikonalTValues(), for the first a elements of Tvalues_ already sorted. */
+        inline double solveSortedTValues
+        (unsigned int a, double t, double tt) const {
+            double updatedT = std::numeric_limits<double>::infinity();
             for (unsigned i = 1; i <= a; ++i) {
-                updatedT = solveEikonalNDims(idx, i);
+                updatedT = solveEikonalNDims(i, t, tt);
                 // If no more dimensions or increasing one dimension will not improve time.
                 if (i == a || (updatedT - Tvalues_[i]) < utils::COMP_MARGIN)
                     break;
@@ -74,14 +362,40 @@ class EikonalSolver : public Solver<grid_t>{
             return updatedT;
         }
 
-    protected:
-        /** \brief Solves the Eikonal equation assuming that Tvalues_
-            is sorted. */
-        double solveEikonalNDims
-        (unsigned int idx, unsigned int dim) {
+        /** \brief Sorts the first n elements of Tvalues_. Sorting networks for 2 and 3
+            elements (2D and 3D grids), insertion sort for more. */
+        inline void sortTValues
+        (unsigned int n) {
+            if (n == 2)
+                sortPair(0, 1);
+            else if (n == 3) {
+                sortPair(0, 1);
+                sortPair(1, 2);
+                sortPair(0, 1);
+            }
+            else
+                for (unsigned int i = 1; i < n; ++i)
+                    for (unsigned int j = i; j > 0 && Tvalues_[j] < Tvalues_[j-1]; --j)
+                        std::swap(Tvalues_[j], Tvalues_[j-1]);
+        }
+
+        /** \brief Compare-exchange element of the sorting networks. */
+        inline void sortPair
+        (unsigned int i, unsigned int j) {
+            const double lo = std::min(Tvalues_[i], Tvalues_[j]);
+            const double hi = std::max(Tvalues_[i], Tvalues_[j]);
+            Tvalues_[i] = lo;
+            Tvalues_[j] = hi;
+        }
+
+        /** \brief Solves the Eikonal equation using the first dim elements of Tvalues_,
+            assuming that they are sorted. t is the time to cross the cell (leafsize/velocity)
+            and tt its square. */
+        inline double solveEikonalNDims
+        (unsigned int dim, double t, double tt) const {
             // Solve for 1 dimension.
             if (dim == 1)
-                return Tvalues_[0] + grid_->getLeafSize() / grid_->getCell(idx).getVelocity();
+                return Tvalues_[0] + t;
 
             // Solve for any number > 1 of dimensions.
             double sumT = 0;
@@ -95,7 +409,7 @@ class EikonalSolver : public Solver<grid_t>{
             // terms but they are cancelled out when solving the quadratic function.
             double a = dim;
             double b = -2*sumT;
-            double c = sumTT - grid_->getLeafSize() * grid_->getLeafSize() / (grid_->getCell(idx).getVelocity()*grid_->getCell(idx).getVelocity());
+            double c = sumTT - tt;
             double quad_term = b*b - 4*a*c;
 
             if (quad_term < 0)
@@ -104,13 +418,26 @@ class EikonalSolver : public Solver<grid_t>{
                 return (-b + sqrt(quad_term))/(2*a);
         }
 
-        /** \brief Auxiliar vector with values T0,T1...Tn-1 variables in the Discretized Eikonal Equation. */
-        std::vector<double>          Tvalues_;
+        /** \brief Auxiliar array with values T0,T1...Tn-1 variables in the Discretized Eikonal Equation. */
+        std::array <double, grid_t::getNDims()> Tvalues_;
 
         /** \brief Auxiliar array which stores the neighbor of each iteration of the computeFM() function. */
-        std::array <unsigned int, 2*grid_t::getNDims()> neighbors_;
+        std::array <index_t, 2*grid_t::getNDims()> neighbors_;
+
+        /** \brief Solutions of the neighbors stored in neighbors_ by solveNeighbors(). */
+        std::array <double, 2*grid_t::getNDims()> neighborTimes_;
+
+        /** \brief If true, the factored Eikonal equation is solved. */
+        bool factored_;
+
+        /** \brief Cells farther than this (in cells) from every initial point are not factored. */
+        double factoredRadius_;
+
+        /** \brief Initial points of the factored Eikonal equation, set in setup(). */
+        std::vector<Source> sources_;
 
         using Solver<grid_t>::grid_;
+        using Solver<grid_t>::init_points_;
 };
 
 #endif /* EIKONALSOLVER_H_*/
@@ -36,6 +36,9 @@
 template < class grid_t > class FIM : public EikonalSolver<grid_t> {
 
     public:
+        typedef typename EikonalSolver<grid_t>::index_t index_t;
+        typedef typename EikonalSolver<grid_t>::value_t value_t;
+
         FIM(double error = 0) : EikonalSolver<grid_t>("FIM"), E_(error) {}
         FIM(const char * name, double error = 0) : EikonalSolver<grid_t>(name), E_(error) {}
 
@@ -50,47 +53,48 @@ template < class grid_t > class FIM : public EikonalSolver<grid_t> {
             double q =-1;
             double p =-1;
             unsigned int n_neighs = 0;
-            unsigned int x_nb = 0;
+            index_t x_nb = 0;
             bool stopWavePropagation = 0;
 
             // Algorithm initialization.
-            for (const unsigned int& i: init_points_) {
-                grid_->getCell(i).setArrivalTime(0);
-                grid_->getCell(i).setState(FMState::FROZEN);
+            for (const index_t& i: init_points_) {
+                (*grid_)[i].setArrivalTime(0);
+                (*grid_)[i].setState(FMState::FROZEN);
 
                 n_neighs = grid_->getNeighbors(i, neighbors_);
                 for (unsigned int s = 0; s < n_neighs; ++s) {// For each neighbor
                     x_nb = neighbors_[s];
-                    if ( (grid_->getCell(x_nb).getState() == FMState::OPEN) && !grid_->getCell(x_nb).isOccupied()) {
+                    if ( ((*grid_)[x_nb].getState() == FMState::OPEN) && !(*grid_)[x_nb].isOccupied()) {
                         active_list_.push_back(x_nb);
-                        grid_->getCell(x_nb).setState(FMState::NARROW);
+                        (*grid_)[x_nb].setState(FMState::NARROW);
                     }
                 }
             }
 
             // Main loop.
             while(!stopWavePropagation && !active_list_.empty()) {
-                for (std::list<unsigned int>::iterator x = active_list_.begin(); x!=active_list_.end(); ++x) { // for each cell of active_list
-                    p = grid_->getCell(*x).getArrivalTime();
+                for (typename std::list<index_t>::iterator x = active_list_.begin(); x!=active_list_.end(); ++x) { // for each cell of active_list
+                    p = (*grid_)[*x].getArrivalTime();
                     q = solveEikonal(*x);
-                    grid_->getCell(*x).setArrivalTime(q);
-                    if (fabs(p - q) <= E_) { // if the cell has converged
+                    (*grid_)[*x].setArrivalTime(q);
+                    // Compared as stored, otherwise rounding would never let float grids converge.
+                    if (fabs(p - value_t(q)) <= E_) { // if the cell has converged
                         n_neighs = grid_->getNeighbors(*x, neighbors_);
                         for (unsigned int s = 0; s < n_neighs; ++s){ // For each neighbor of converged cells of active_list
                             x_nb = neighbors_[s];
-                            if (grid_->getCell(x_nb).getState() != FMState::NARROW && !grid_->getCell(x_nb).isOccupied()) {
-                                p = grid_->getCell(x_nb).getArrivalTime();
+                            if ((*grid_)[x_nb].getState() != FMState::NARROW && !(*grid_)[x_nb].isOccupied()) {
+                                p = (*grid_)[x_nb].getArrivalTime();
                                 q = solveEikonal(x_nb);
-                                if (utils::isTimeBetterThan(q, p)) {
-                                    grid_->getCell(x_nb).setArrivalTime(q);
+                                if (utils::isTimeBetterThan<value_t>(q, p)) {
+                                    (*grid_)[x_nb].setArrivalTime(q);
                                     active_list_.insert(x, x_nb);
-                                    grid_->getCell(x_nb).setState(FMState::NARROW);
+                                    (*grid_)[x_nb].setState(FMState::NARROW);
                                     }
                             }
                         }// For each neighbor of converged cells of active_list
                     if (*x == goal_idx_)
                         stopWavePropagation = true;
-                    grid_->getCell(*x).setState(FMState::FROZEN);
+                    (*grid_)[*x].setState(FMState::FROZEN);
                     x = active_list_.erase(x);
                     --x;
                     }// if the cell has converged
@@ -120,7 +124,7 @@ template < class grid_t > class FIM : public EikonalSolver<grid_t> {
 
     private:
         /** \brief List wich stores the narrow band of each iteration. */
-        std::list<unsigned int> active_list_;
+        std::list<index_t>      active_list_;
         
         /** \brief Error threshold value that reveals if a cell has converged. */
         double E_;
@@ -12,9 +12,15 @@
     - FMDaryHeap wrap for the Boost D_ary heap (generalization of binary heaps).
     * Set by default if no other heap is specified. The arity has been set to 2
     * (binary heap) since it has been tested to be the more efficient in this algorithm.
+    * FMDaryHeap<cell_t, FMPagedStorage> allocates the handles of the cells only in the pages
+    * of the grid reached, better for goal-directed queries in big grids (FMM*).
+    - FMIndexedHeap: D-ary heap (arity 2, 4 or 8 given as template parameter) with the entries
+    * stored inline and a flat array with the position of every cell. No Boost handles.
+    - FMRadixHeap: monotone radix heap with amortized O(1) operations. Only without heuristics.
     - FMFibHeap wrap for the Boost Fibonacci heap.
     - FMPriorityQueue wrap to the std::PriorityQueue class. This heap implies the implementation
     * of the Simplified FMM (SFMM) method, done automatically because of the FMPriorityQueue::increase implementation.
+    * The duplicated entries of a cell are discarded by the heap, so every cell is accepted once.
 
     @par External documentation:
         FMM:
@@ -61,16 +67,21 @@
 /** \brief Heuristic strategy to be used. TIME = DISTANCE/local velocity. */
 enum HeurStrategy {NOHEUR = 0, TIME, DISTANCE};
 
-template < class grid_t, class heap_t = FMDaryHeap<FMCell> >  class FMM : public EikonalSolver<grid_t> {
+template < class grid_t, class heap_t = FMDaryHeap<typename grid_t::cell_t> >  class FMM : public EikonalSolver<grid_t> {
 
     public:
-        FMM(HeurStrategy h = NOHEUR) : EikonalSolver<grid_t>("FMM"), heurStrategy_(h), precomputed_(false) {
+        typedef typename EikonalSolver<grid_t>::index_t index_t;
+        typedef typename EikonalSolver<grid_t>::value_t value_t;
+
+        FMM(HeurStrategy h = NOHEUR) : EikonalSolver<grid_t>("FMM"), heurStrategy_(h), precomputed_(false),
+            maxModified_(0), modifiedOverflow_(false) {
             /// \todo automate the naming depending on the heap.
             //if (static_cast<FMFibHeap>(heap_t))
              //   name_ = "FMMFib";
         }
 
-        FMM(const char * name, HeurStrategy h = NOHEUR) : EikonalSolver<grid_t>(name), heurStrategy_(h), precomputed_(false) {}
+        FMM(const char * name, HeurStrategy h = NOHEUR) : EikonalSolver<grid_t>(name), heurStrategy_(h), precomputed_(false),
+            maxModified_(0), modifiedOverflow_(false) {}
 
         virtual ~FMM() { clear(); }
 
@@ -79,9 +90,12 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> >  class FMM : public
         () {
             EikonalSolver<grid_t>::setup();
             narrow_band_.setMaxSize(grid_->size());
+            modified_.clear();
+            maxModified_ = grid_->size() / 8;
+            modifiedOverflow_ = false;
             setHeuristics(heurStrategy_); // Redundant, but safe.
 
-            if (int(goal_idx_) == -1 && heurStrategy_ != NOHEUR) {
+            if (goal_idx_ == index_t(-1) && heurStrategy_ != NOHEUR) {
                 console::warning("FMM/SFMM: Heuristics set with no goal point. Deactivating heuristics.");
                 heurStrategy_ = NOHEUR;
             }
@@ -93,53 +107,51 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> >  class FMM : public
             if (!setup_)
                 setup();
 
-            unsigned int j = 0;
+            index_t j = 0;
             unsigned int n_neighs = 0;
             bool stopWavePropagation = false;
 
             // Algorithm initialization
-            for (unsigned int &i: init_points_) { // For each initial point
-                grid_->getCell(i).setArrivalTime(0);
+            for (index_t &i: init_points_) { // For each initial point
+                (*grid_)[i].setArrivalTime(0);
+                markModified(i);
                 // Include heuristics if necessary.
                 if (heurStrategy_ == TIME)
-                    grid_->getCell(i).setHeuristicTime( getPrecomputedDistance(i)/grid_->getCell(i).getVelocity() );
+                    (*grid_)[i].setHeuristicTime( getPrecomputedDistance(i)/(*grid_)[i].getVelocity() );
                 else if (heurStrategy_ == DISTANCE)
-                    grid_->getCell(i).setHeuristicTime( getPrecomputedDistance(i) );
-                narrow_band_.push( &(grid_->getCell(i)) );
+                    (*grid_)[i].setHeuristicTime( getPrecomputedDistance(i) );
+                narrow_band_.push( (*grid_)[i] );
             }
 
             // Main loop.
-            unsigned int idxMin = 0;
+            index_t idxMin = 0;
             while (!stopWavePropagation && !narrow_band_.empty()) {
                 idxMin = narrow_band_.popMinIdx();
-                n_neighs = grid_->getNeighbors(idxMin, neighbors_);
-                grid_->getCell(idxMin).setState(FMState::FROZEN);
+                (*grid_)[idxMin].setState(FMState::FROZEN);
+                n_neighs = solveNeighbors(idxMin); // Neighbors not frozen nor occupied.
                 for (unsigned int s = 0; s < n_neighs; ++s) {
                     j = neighbors_[s];
-                    if ((grid_->getCell(j).getState() == FMState::FROZEN) || grid_->getCell(j).isOccupied())
-                        continue;
-                    else {
-                        double new_arrival_time = solveEikonal(j);
-
-                        // Include heuristics if necessary.
-                        if (heurStrategy_ == TIME)
-                            grid_->getCell(j).setHeuristicTime( getPrecomputedDistance(j)/grid_->getCell(j).getVelocity() );
-                        else if (heurStrategy_ == DISTANCE)
-                            grid_->getCell(j).setHeuristicTime( getPrecomputedDistance(j) );
-
-                        // Updating narrow band if necessary.
-                        if (grid_->getCell(j).getState() == FMState::NARROW) {
-                            if (utils::isTimeBetterThan(new_arrival_time, grid_->getCell(j).getArrivalTime())) {
-                                grid_->getCell(j).setArrivalTime(new_arrival_time);
-                                narrow_band_.increase( &(grid_->getCell(j)) );
-                            }
+                    const double new_arrival_time = neighborTimes_[s];
+
+                    // Include heuristics if necessary.
+                    if (heurStrategy_ == TIME)
+                        (*grid_)[j].setHeuristicTime( getPrecomputedDistance(j)/(*grid_)[j].getVelocity() );
+                    else if (heurStrategy_ == DISTANCE)
+                        (*grid_)[j].setHeuristicTime( getPrecomputedDistance(j) );
+
+                    // Updating narrow band if necessary.
+                    if ((*grid_)[j].getState() == FMState::NARROW) {
+                        if (utils::isTimeBetterThan<value_t>(new_arrival_time, (*grid_)[j].getArrivalTime())) {
+                            (*grid_)[j].setArrivalTime(new_arrival_time);
+                            narrow_band_.increase( (*grid_)[j] );
                         }
-                        else {
-                            grid_->getCell(j).setState(FMState::NARROW);
-                            grid_->getCell(j).setArrivalTime(new_arrival_time);
-                            narrow_band_.push( &(grid_->getCell(j)) );
-                        } // neighbors_ open.
-                    } // neighbors_ not frozen.
+                    }
+                    else {
+                        (*grid_)[j].setState(FMState::NARROW);
+                        (*grid_)[j].setArrivalTime(new_arrival_time);
+                        narrow_band_.push( (*grid_)[j] );
+                        markModified(j);
+                    } // neighbors_ open.
                 } // For each neighbor.
 
                 if (idxMin == goal_idx_)
@@ -151,7 +163,7 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> >  class FMM : public
             if not done already. */
         void setHeuristics
         (HeurStrategy h) {
-            if (h && int(goal_idx_)!=-1) {
+            if (h && goal_idx_ != index_t(-1)) {
                 heurStrategy_ = h;
                 grid_->idx2coord(goal_idx_, heur_coord_);
                 if (!precomputed_)
@@ -169,11 +181,25 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> >  class FMM : public
         () {
             narrow_band_.clear();
             distances_.clear();
+            modified_.clear();
+            modifiedOverflow_ = false;
             precomputed_ = false;
         }
 
+        /** \brief If the solver has run since the last reset, only the cells it modified
+            are cleaned (the grid was clean when it was set up). If it modified more than
+            1/8 of the grid, the whole grid is cleaned instead: a sequential pass is faster
+            than visiting the cells in the order they were reached. */
         virtual void reset
         () {
+            if (setup_) {
+                if (modifiedOverflow_)
+                    grid_->clean();
+                else
+                    grid_->clean(modified_);
+            }
+            modified_.clear();
+            modifiedOverflow_ = false;
             EikonalSolver<grid_t>::reset();
             narrow_band_.clear();
         }
@@ -181,7 +207,7 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> >  class FMM : public
         /** \brief Computes euclidean distance between goal and rest of cells. */
         virtual void precomputeDistances
         () {
-            distances_.reserve(grid_->size());
+            distances_.resize(grid_->size());
             std::array <unsigned int, grid_t::getNDims()> coords;
             double dist = 0;
 
@@ -201,17 +227,14 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> >  class FMM : public
         /** \brief Extracts the euclidean distance calculated from precomputeDistances
             function distance between two positions. */
         virtual double getPrecomputedDistance
-        (const unsigned int idx) {
+        (const index_t idx) {
             std::array <unsigned int, grid_t::getNDims()> position, distance;
             grid_->idx2coord(idx, position);
 
             for (unsigned int i = 0; i < grid_t::getNDims(); ++i)
                 distance[i] = utils::absUI(position[i] - heur_coord_[i]);
 
-            unsigned int idx_dist;
-            grid_->coord2idx(distance, idx_dist);
-
-            return distances_[idx_dist];
+            return distances_[grid_->coord2idx(distance)];
         }
 
         virtual void printRunInfo
@@ -232,9 +255,30 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> >  class FMM : public
         using EikonalSolver<grid_t>::name_;
         using EikonalSolver<grid_t>::time_;
         using EikonalSolver<grid_t>::solveEikonal;
+        using EikonalSolver<grid_t>::solveNeighbors;
         using EikonalSolver<grid_t>::neighbors_;
+        using EikonalSolver<grid_t>::neighborTimes_;
+
+        /** \brief Returns the heap used as narrow band. */
+        const heap_t & getNarrowBand
+        () const {
+            return narrow_band_;
+        }
 
     private:
+        /** \brief Adds idx to the cells to be cleaned by reset(). Not required if the
+            grid is epoch-stamped. Once the list reaches maxModified_ cells, no more cells
+            are added and reset() cleans the whole grid. */
+        inline void markModified
+        (index_t idx) {
+            if (nDGridStorage<typename grid_t::cell_t>::stamped || modifiedOverflow_)
+                return;
+            if (modified_.size() < maxModified_)
+                modified_.push_back(idx);
+            else
+                modifiedOverflow_ = true;
+        }
+
         /** \brief Instance of the heap used. */
         heap_t                                          narrow_band_;
 
@@ -249,6 +293,15 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> >  class FMM : public
 
         /** \brief Goal coord, goal of the second wave propagation (actually the initial point of the path). */
         std::array <unsigned int, grid_t::getNDims()>   heur_coord_;
+
+        /** \brief Cells modified since the last reset (dirty list). */
+        std::vector<index_t>                            modified_;
+
+        /** \brief Maximum size of modified_, 1/8 of the grid. */
+        size_t                                          maxModified_;
+
+        /** \brief True if more than maxModified_ cells were modified since the last reset. */
+        bool                                            modifiedOverflow_;
 };
 
 #endif /* FMM_HPP_*/
@@ -58,7 +58,7 @@
 #include <fast_methods/ndgridmap/ndgridmap.hpp>
 #include <fast_methods/console/console.h>
 
-template < class grid_t, class heap_t = FMDaryHeap<FMCell> >  class FMMStar : public FMM<grid_t, heap_t> {
+template < class grid_t, class heap_t = FMDaryHeap<typename grid_t::cell_t> >  class FMMStar : public FMM<grid_t, heap_t> {
 
     /** \brief Shorthand for base solver. */
     typedef FMM<grid_t, heap_t> FMMBase;
@@ -13,6 +13,12 @@
     NOTE: The sweeping directions are inverted with respect to the paper to make implementation easier. And sweeping
     is implemented recursively (undetermined number of nested for loops) to achieve n-dimensional behaviour.
 
+    In 2D and 3D grids the most inner loop is solved row by row (see sweepRow()): along a row, only the
+    neighbors in dimension 0 depend on the cells updated before in the same row. The neighbors of the
+    whole row are gathered and the Eikonal equation is solved for all its cells at once with SIMD
+    instructions (see SimdPack). Then, a sequential pass solves again only the cells whose previous cell
+    in the row was updated. The results are the same as those of the cell by cell sweep.
+
     Copyright (C) 2015 Javier V. Gomez
     www.javiervgomez.com
 
@@ -32,8 +38,12 @@
 #define FSM_HPP_
 
 #include <algorithm>
+#include <initializer_list>
+#include <limits>
+#include <vector>
 
 #include <fast_methods/fm/eikonalsolver.hpp>
+#include <fast_methods/utils/simd.h>
 #include <fast_methods/utils/utils.h>
 
 
@@ -41,6 +51,10 @@
 template < class grid_t > class FSM : public EikonalSolver<grid_t> {
 
     public:
+        typedef typename EikonalSolver<grid_t>::index_t index_t;
+        typedef typename EikonalSolver<grid_t>::value_t value_t;
+        using EikonalSolver<grid_t>::setEnvironment;
+
         FSM(unsigned maxSweeps = std::numeric_limits<unsigned>::max()) : EikonalSolver<grid_t>("FSM"),
             sweeps_(0),
             maxSweeps_(maxSweeps) {}
@@ -56,14 +70,23 @@ template < class grid_t > class FSM : public EikonalSolver<grid_t> {
             EikonalSolver<grid_t>::setEnvironment(g);
             // Filling the size of the dimensions...
             std::array<unsigned, grid_t::getNDims()> dimsize = g->getDimSizes();
-            size_t ncells = 1;
-            for (size_t i = 0; i < grid_t::getNDims(); ++i) {
+            for (size_t i = 0; i < grid_t::getNDims(); ++i)
                 dimsize_[i] = dimsize[i];
-                ncells *= dimsize[i];
-                d_[i] = ncells;
-            }
 
-            Tvalues_.reserve(grid_t::getNDims());
+            // Row buffers.
+            for (std::vector<index_t> * v : {&row_, &rowNext_})
+                v->resize(dimsize_[0]);
+            for (std::vector<char> * v : {&rowFree_, &rowNextFree_, &rowOpen_, &rowNextOpen_, &rowSolve_})
+                v->resize(dimsize_[0]);
+            for (std::vector<double> * v : {&rowPrevT_, &rowT_, &rowNextT_})
+                v->assign(dimsize_[0] + 2, std::numeric_limits<double>::infinity());
+            for (std::vector<double> * v : {&rowVel_, &rowNextVel_, &rowCross_, &rowCross2_,
+                    &rowLo_, &rowHi_, &rowCandidate_})
+                v->resize(dimsize_[0]);
+            for (size_t i = 2; i < grid_t::getNDims(); ++i) {
+                rowLower_[i].resize(dimsize_[0]);
+                rowUpper_[i].resize(dimsize_[0]);
+            }
         }
 
         /** \brief Executes EikonalSolver setup and other checks. */
@@ -71,7 +94,7 @@ template < class grid_t > class FSM : public EikonalSolver<grid_t> {
         () {
             EikonalSolver<grid_t>::setup();
             initializeSweepArrays();
-            if (int(goal_idx_) != -1)
+            if (goal_idx_ != index_t(-1))
                 console::warning("Setting a goal point in FSM (and LSM) is experimental. It may lead to wrong results.");
         }
 
@@ -82,8 +105,8 @@ template < class grid_t > class FSM : public EikonalSolver<grid_t> {
                 setup();
 
             // Initialization
-            for (unsigned int i: init_points_) // For each initial point
-                grid_->getCell(i).setArrivalTime(0);
+            for (index_t i: init_points_) // For each initial point
+                (*grid_)[i].setArrivalTime(0);
 
             keepSweeping_ = true;
             stopPropagation_ = false;
@@ -114,32 +137,265 @@ template < class grid_t > class FSM : public EikonalSolver<grid_t> {
 
     protected:
         /** \brief Equivalent to nesting as many for loops as dimensions. For every most inner
-         * loop iteration, solveForIdx() is called for the corresponding idx. */
+         * loop iteration, solveForIdx() is called for the corresponding idx. The index of the
+         * first cell of every row is computed from its coordinates and then the grid
+         * is stepped along dimension 0, so that it works for any grid layout. In 2D and 3D,
+         * the most inner loop is sweepRow(). */
         void recursiveIteration
-        (size_t depth, int it = 0) {
+        (size_t depth) {
             if (depth > 0) {
-                for(int i = inits_[depth]; i != ends_[depth]; i += incs_[depth])
-                    recursiveIteration(depth-1, it + i*d_[depth-1]);
+                for(int i = inits_[depth]; i != ends_[depth]; i += incs_[depth]) {
+                    coords_[depth] = i;
+                    recursiveIteration(depth-1);
+                }
             }
+            else if (grid_t::getNDims() == 2 || grid_t::getNDims() == 3)
+                sweepRow();
             else {
-                for(int i = inits_[0]; i != ends_[0]; i += incs_[0])
-                    if (!grid_->getCell(it+i).isOccupied())
-                        solveForIdx(it+i);
+                coords_[0] = inits_[0];
+                index_t idx = grid_->coord2idx(coords_);
+                for(int i = inits_[0]; i != ends_[0]; i += incs_[0], idx = grid_->step(idx, 0, incs_[0]))
+                    if (!(*grid_)[idx].isOccupied())
+                        solveForIdx(idx);
+            }
+        }
+
+        /** \brief Sweeps the row given by coords_ (dimensions 1 and higher). The previous row
+            (already swept) and the next row of dimension 1 are kept in buffers, so that every
+            row is read from the grid only once. The Eikonal equation is solved for the whole
+            row at once (solveRowCandidates()) with the times of the row before the sweep, and
+            then solveRow() goes through the cells in order, solving again only those whose
+            previous cell in the row has been updated. */
+        void sweepRow
+        () {
+            const unsigned int n = dimsize_[0];
+            const double inf = std::numeric_limits<double>::infinity();
+
+            // First row of dimension 1: there is no previous row.
+            if (int(coords_[1]) == inits_[1]) {
+                gatherRow(row_, rowT_, rowVel_, rowFree_, rowOpen_);
+                std::fill(rowPrevT_.begin(), rowPrevT_.end(), inf);
+            }
+            else {
+                std::swap(rowPrevT_, rowT_);
+                std::swap(rowT_, rowNextT_);
+                std::swap(row_, rowNext_);
+                std::swap(rowVel_, rowNextVel_);
+                std::swap(rowFree_, rowNextFree_);
+                std::swap(rowOpen_, rowNextOpen_);
+            }
+
+            if (int(coords_[1]) + incs_[1] != ends_[1]) {
+                coords_[1] += incs_[1];
+                gatherRow(rowNext_, rowNextT_, rowNextVel_, rowNextFree_, rowNextOpen_);
+                coords_[1] -= incs_[1];
+            }
+            else
+                std::fill(rowNextT_.begin(), rowNextT_.end(), inf);
+
+            // Rows with few cells to solve are solved cell by cell, as well as all the rows
+            // for the factored Eikonal equation (not vectorized).
+            const unsigned int nsolve = selectRowCells();
+            if (nsolve == 0)
+                return;
+            if (nsolve < n/4 || factored_) {
+                solveRow(false);
+                return;
+            }
+
+            // Neighbors in the previous and next rows of dimension 2 (3D grids).
+            for (unsigned int d = 2; d < grid_t::getNDims(); ++d) {
+                const bool lower = coords_[d] > 0;
+                const bool upper = int(coords_[d]) < dimsize_[d] - 1;
+                std::vector<double> & lo = rowLower_[d];
+                std::vector<double> & up = rowUpper_[d];
+                for (unsigned int k = 0; k < n; ++k) {
+                    lo[k] = inf;
+                    up[k] = inf;
+                    if (!rowSolve_[k])
+                        continue;
+                    if (lower)
+                        lo[k] = (*grid_)[grid_->step(row_[k], d, -1)].getArrivalTime();
+                    if (upper)
+                        up[k] = (*grid_)[grid_->step(row_[k], d, 1)].getArrivalTime();
+                }
+            }
+
+            const unsigned int k = solveRowCandidates<SimdPack>(0, n);
+            solveRowCandidates<ScalarPack>(k, n);
+
+            solveRow(true);
+        }
+
+        /** \brief Reads from the grid the row given by coords_: indices (in sweep order),
+            arrival times (shifted one position, see rowT_), velocities, free (not occupied)
+            cells and unlocked (FMState::OPEN) cells. */
+        void gatherRow
+        (std::vector<index_t> & idxs, std::vector<double> & times, std::vector<double> & vels,
+         std::vector<char> & free, std::vector<char> & open) {
+            coords_[0] = inits_[0];
+            index_t idx = grid_->coord2idx(coords_);
+            for (unsigned int k = 0; k < idxs.size(); ++k, idx = grid_->step(idx, 0, incs_[0])) {
+                idxs[k] = idx;
+                times[k+1] = (*grid_)[idx].getArrivalTime();
+                vels[k] = (*grid_)[idx].getVelocity();
+                free[k] = !(*grid_)[idx].isOccupied();
+                open[k] = (*grid_)[idx].getState() == FMState::OPEN;
+            }
+        }
+
+        /** \brief Sets the cells of the current row to be solved: all the free ones. Returns
+            how many they are. */
+        virtual unsigned int selectRowCells
+        () {
+            rowSolve_ = rowFree_;
+            return std::count(rowSolve_.begin(), rowSolve_.end(), 1);
+        }
+
+        /** \brief Solves the Eikonal equation, as EikonalSolver::solveEikonal() does, for the
+            cells k0, k0+P::width... of the row with the current values of their neighbors.
+            Stores the solutions in rowCandidate_ and, for solveRowEikonal(), the minimum
+            neighbor values of dimensions 1 and higher, sorted, in rowLo_ and rowHi_. Returns
+            the first cell not solved, to be done with a narrower pack. */
+        template <class P>
+        unsigned int solveRowCandidates
+        (unsigned int k0, unsigned int n) {
+            typedef typename P::type pack_t;
+            typedef typename P::mask mask_t;
+            const pack_t inf = P::set1(std::numeric_limits<double>::infinity());
+            const pack_t margin = P::set1(utils::COMP_MARGIN);
+            const pack_t leafsize = P::set1(grid_->getLeafSize());
+            const pack_t leafsize2 = P::mul(leafsize, leafsize);
+
+            unsigned int k = k0;
+            for (; k + P::width <= n; k += P::width) {
+                const pack_t T = P::load(&rowT_[k+1]);
+                const pack_t vel = P::load(&rowVel_[k]);
+                const pack_t t = P::div(leafsize, vel);
+                const pack_t tt = P::div(leafsize2, P::mul(vel, vel));
+                P::store(&rowCross_[k], t);
+                P::store(&rowCross2_[k], tt);
+
+                // Minimum neighbor values lower than T in each dimension, infinity otherwise.
+                pack_t m0 = P::min(P::load(&rowT_[k]), P::load(&rowT_[k+2]));
+                m0 = P::select(P::lt(m0, T), m0, inf);
+                pack_t m1 = P::min(P::load(&rowPrevT_[k+1]), P::load(&rowNextT_[k+1]));
+                m1 = P::select(P::lt(m1, T), m1, inf);
+                pack_t m2 = inf;
+                if (grid_t::getNDims() == 3) {
+                    m2 = P::min(P::load(&rowLower_[2][k]), P::load(&rowUpper_[2][k]));
+                    m2 = P::select(P::lt(m2, T), m2, inf);
+                    const pack_t hi = P::max(m1, m2);
+                    m1 = P::min(m1, m2);
+                    m2 = hi;
+                    P::store(&rowHi_[k], hi);
+                }
+                P::store(&rowLo_[k], m1);
+
+                // Sorting network, infinities are left at the end.
+                const pack_t v0 = P::min(m0, m1);
+                pack_t v1 = P::max(m0, m1);
+                const pack_t v2 = P::max(v1, m2);
+                v1 = P::min(v1, m2);
+
+                // solveSortedTValues() for 1, 2 and 3 values. As solveEikonalNDims() does,
+                // (-b + sqrt(b^2 - 4ac))/2a with a = dimensions, b = -2 sumT, c = sumTT - tt.
+                const pack_t s1 = P::add(v0, t);
+                const pack_t sumT2 = P::add(v0, v1);
+                const pack_t sumTT2 = P::add(P::mul(v0, v0), P::mul(v1, v1));
+                const pack_t b2 = P::mul(P::set1(-2), sumT2);
+                const pack_t quad2 = P::sub(P::mul(b2, b2), P::mul(P::set1(8), P::sub(sumTT2, tt)));
+                // Multiplying by 0.25 is exactly dividing by 2a = 4.
+                pack_t s2 = P::mul(P::add(P::mul(P::set1(2), sumT2), P::sqrt(quad2)), P::set1(0.25));
+                s2 = P::select(P::lt(quad2, P::set1(0)), inf, s2);
+                pack_t sol = s2;
+                if (grid_t::getNDims() == 3) {
+                    const pack_t sumT3 = P::add(sumT2, v2);
+                    const pack_t sumTT3 = P::add(sumTT2, P::mul(v2, v2));
+                    const pack_t b3 = P::mul(P::set1(-2), sumT3);
+                    const pack_t quad3 = P::sub(P::mul(b3, b3), P::mul(P::set1(12), P::sub(sumTT3, tt)));
+                    pack_t s3 = P::div(P::add(P::mul(P::set1(2), sumT3), P::sqrt(quad3)), P::set1(6));
+                    s3 = P::select(P::lt(quad3, P::set1(0)), inf, s3);
+                    const mask_t two = P::lt(P::sub(s2, v2), margin);
+                    sol = P::select(two, s2, P::select(P::lt(v2, inf), s3, s2));
+                }
+                const mask_t one = P::lt(P::sub(s1, v1), margin);
+                sol = P::select(one, s1, sol);
+                P::store(&rowCandidate_[k], P::select(P::lt(v0, inf), sol, inf));
+            }
+            return k;
+        }
+
+        /** \brief Solves the Eikonal equation for the cell k of the row with the current times of
+            its neighbors in the row, which might have changed after solveRowCandidates(). Returns
+            exactly the same as EikonalSolver::solveEikonal(). */
+        double solveRowEikonal
+        (unsigned int k) {
+            const double inf = std::numeric_limits<double>::infinity();
+            double minT = std::min(rowT_[k], rowT_[k+2]);
+            if (!(minT < rowT_[k+1]))
+                minT = inf;
+
+            // Inserted in the sorted values of the other dimensions, infinities are left at the end.
+            const double lo = rowLo_[k];
+            const double hi = (grid_t::getNDims() == 3) ? rowHi_[k] : inf;
+            Tvalues_[0] = std::min(minT, lo);
+            double v1 = std::max(minT, lo);
+            if (grid_t::getNDims() == 3) {
+                Tvalues_[grid_t::getNDims()-1] = std::max(v1, hi);
+                v1 = std::min(v1, hi);
+            }
+            Tvalues_[1] = v1;
+
+            unsigned int a = 0;
+            while (a < grid_t::getNDims() && Tvalues_[a] < inf)
+                ++a;
+            if (a == 0)
+                return inf;
+            return solveSortedTValues(a, rowCross_[k], rowCross2_[k]);
+        }
+
+        /** \brief Executes one solving iteration of the FSM for every cell of the row, in order.
+            If candidates is false, solveRowCandidates() was not called and the cells are solved
+            with solveEikonal(). */
+        virtual void solveRow
+        (bool candidates) {
+            bool updated = false; // Previous cell updated in this sweep.
+            for (unsigned int k = 0; k < row_.size(); ++k) {
+                if (!rowSolve_[k]) {
+                    updated = false;
+                    continue;
+                }
+                double newTime;
+                if (!candidates)
+                    newTime = solveEikonal(row_[k]);
+                else
+                    newTime = updated ? solveRowEikonal(k) : rowCandidate_[k];
+                updated = updateArrivalTime(row_[k], rowT_[k+1], newTime);
+                if (updated)
+                    rowT_[k+1] = value_t(newTime); // As stored in the grid.
             }
         }
 
         /** \brief Actually executes one solving iteration of the FSM. */
         virtual void solveForIdx
-        (unsigned idx) {
-            const double prevTime = grid_->getCell(idx).getArrivalTime();
-            const double newTime = solveEikonal(idx);
-            if(utils::isTimeBetterThan(newTime, prevTime)) {
-                grid_->getCell(idx).setArrivalTime(newTime);
+        (index_t idx) {
+            updateArrivalTime(idx, (*grid_)[idx].getArrivalTime(), solveEikonal(idx));
+        }
+
+        /** \brief Sets newTime to the cell idx if it is better than prevTime, its current
+            time. Returns true if it was updated. */
+        bool updateArrivalTime
+        (index_t idx, double prevTime, double newTime) {
+            if(utils::isTimeBetterThan<value_t>(newTime, prevTime)) {
+                (*grid_)[idx].setArrivalTime(newTime);
                 keepSweeping_ = true;
+                return true;
             }
             // EXPERIMENTAL - Value not updated, it has converged
             else if(!std::isnan(newTime) && !std::isinf(newTime) && (idx == goal_idx_))
                 stopPropagation_ = true;
+            return false;
         }
 
         /** \brief Set the sweep variables: initial and final indices for iterations,
@@ -194,6 +450,8 @@ template < class grid_t > class FSM : public EikonalSolver<grid_t> {
         using EikonalSolver<grid_t>::time_;
         using EikonalSolver<grid_t>::Tvalues_;
         using EikonalSolver<grid_t>::solveEikonal;
+        using EikonalSolver<grid_t>::factored_;
+        using EikonalSolver<grid_t>::solveSortedTValues;
 
         /** \brief Number of sweeps performed. */
         unsigned int sweeps_;
@@ -219,9 +477,41 @@ template < class grid_t > class FSM : public EikonalSolver<grid_t> {
         /** \brief Size of each dimension, extended to the maximum size. Extended dimensions always 1. */
         std::array<int, grid_t::getNDims()> dimsize_;
 
-        /** \brief Auxiliar array to speed up indexing generalization: stores parcial multiplications of dimensions sizes. d_[0] = dimsize_[0];
-            d_[1] = dimsize_[0]*dimsize_[1]; etc. */
-        std::array<int, grid_t::getNDims()> d_;
+        /** \brief Coordinates of the row being swept by recursiveIteration(). */
+        std::array<unsigned int, grid_t::getNDims()> coords_;
+
+        /** \brief Indices of the cells of the row being swept and of the next one, in sweep order. */
+        std::vector<index_t> row_, rowNext_;
+
+        /** \brief Arrival times of the cells of the previous, current and next rows. Cell k is
+            stored in position k+1, the first and last elements are infinity. Those of the
+            current row are kept updated during the sweep. */
+        std::vector<double> rowPrevT_, rowT_, rowNextT_;
+
+        /** \brief Velocities of the cells of the current and next rows. */
+        std::vector<double> rowVel_, rowNextVel_;
+
+        /** \brief Free cells of the current and next rows. */
+        std::vector<char> rowFree_, rowNextFree_;
+
+        /** \brief Unlocked cells of the current and next rows (only used by LSM). */
+        std::vector<char> rowOpen_, rowNextOpen_;
+
+        /** \brief Cells of the current row to be solved (see selectRowCells()). */
+        std::vector<char> rowSolve_;
+
+        /** \brief Times to cross the cells of the row (leafsize/velocity) and their squares. */
+        std::vector<double> rowCross_, rowCross2_;
+
+        /** \brief Arrival times of the neighbors of the row in the previous and next rows of
+            dimensions 2 and higher, indexed by dimension. */
+        std::array<std::vector<double>, grid_t::getNDims()> rowLower_, rowUpper_;
+
+        /** \brief Minimum neighbor values in dimensions 1 and higher, sorted. */
+        std::vector<double> rowLo_, rowHi_;
+
+        /** \brief Solutions of the cells of the row computed by solveRowCandidates(). */
+        std::vector<double> rowCandidate_;
 };
 
 #endif /* FSM_HPP_*/
@@ -33,6 +33,8 @@
 template < class grid_t > class GMM : public EikonalSolver <grid_t> {
 
     public:
+        typedef typename EikonalSolver<grid_t>::index_t index_t;
+
         GMM(double dt = -1) : EikonalSolver<grid_t>("GMM"), deltau_(dt) {}
         
         GMM(const char * name, double dt = -1) : EikonalSolver<grid_t>(name), deltau_(dt) {}
@@ -57,28 +59,24 @@ template < class grid_t > class GMM : public EikonalSolver <grid_t> {
                 setup();
 
             unsigned int n_neighs;
-            unsigned int j = 0;
+            index_t j = 0;
             bool stopWavePropagation = false;
 
             // Algorithm initialization
             tm_= std::numeric_limits<double>::infinity();
-            for (unsigned int &i: init_points_) { // For each initial point
-                grid_->getCell(i).setArrivalTime(0);
-                grid_->getCell(i).setState(FMState::FROZEN);
-                n_neighs = grid_->getNeighbors(i, neighbors_);
+            for (index_t &i: init_points_) { // For each initial point
+                (*grid_)[i].setArrivalTime(0);
+                (*grid_)[i].setState(FMState::FROZEN);
+                n_neighs = solveNeighbors(i); // Neighbors not frozen nor occupied.
                 for (unsigned int s = 0; s < n_neighs; ++s){  // For each neighbor
                     j = neighbors_[s];
-                    if ((grid_->getCell(j).getState() == FMState::FROZEN) || grid_->getCell(j).isOccupied())
-                        continue;
-                    else {
-                        double new_arrival_time = solveEikonal(j);
-                        if (new_arrival_time < tm_){
-                            tm_ = new_arrival_time;
-                        }
-                        grid_->getCell(j).setArrivalTime(new_arrival_time);
-                        grid_->getCell(j).setState(FMState::NARROW);
-                        gamma_.push_back(j);
-                    } // neighbors open.
+                    const double new_arrival_time = neighborTimes_[s];
+                    if (new_arrival_time < tm_){
+                        tm_ = new_arrival_time;
+                    }
+                    (*grid_)[j].setArrivalTime(new_arrival_time);
+                    (*grid_)[j].setState(FMState::NARROW);
+                    gamma_.push_back(j);
                 } // For each neighbor.
             } // For each initial point.
 
@@ -87,27 +85,22 @@ template < class grid_t > class GMM : public EikonalSolver <grid_t> {
 
                 tm_ += deltau_;
 
-                std::list<unsigned int>::reverse_iterator k = gamma_.rbegin();
-                std::list<unsigned int>::iterator i = k.base();//iterator points to the next element the reverse_iterator is currently pointing to
+                typename std::list<index_t>::reverse_iterator k = gamma_.rbegin();
+                typename std::list<index_t>::iterator i = k.base();//iterator points to the next element the reverse_iterator is currently pointing to
                 i--;
                 k = gamma_.rend();
-                std::list<unsigned int>::iterator q = k.base();
+                typename std::list<index_t>::iterator q = k.base();
                 q--;//the end of a reverse list is the first element of that list
                 //This is needed because some functions, like std::list::erase, do not work with reverse iterators
 
                 // First pass
                 for( ; i!=q; --i) {//for each gamma in the reverse order
-                    if( grid_->getCell(*i).getArrivalTime() <= tm_) {
-                        n_neighs = grid_->getNeighbors(*i, neighbors_);
+                    if( (*grid_)[*i].getArrivalTime() <= tm_) {
+                        n_neighs = solveNeighbors(*i); // Not frozen nor obstacles (velocity = 0).
                         for (unsigned int s = 0; s < n_neighs; ++s){  // For each neighbor of gamma
                             j = neighbors_[s];
-                            if ( (grid_->getCell(j).getState() == FMState::FROZEN) || grid_->getCell(j).isOccupied() || (grid_->getCell(j).getVelocity() == 0)) // If Frozen,obstacle or velocity = 0
-                                continue;
-                            else {
-                                double new_arrival_time = solveEikonal(j);
-                                if (new_arrival_time < grid_->getCell(j).getArrivalTime()) // Updating narrow band if necessary.
-                                    grid_->getCell(j).setArrivalTime(new_arrival_time);
-                            }
+                            if (neighborTimes_[s] < (*grid_)[j].getArrivalTime()) // Updating narrow band if necessary.
+                                (*grid_)[j].setArrivalTime(neighborTimes_[s]);
                         }//for each neighbor of gamma
                     }
                 }//for each gamma in the reverse order
@@ -116,24 +109,19 @@ template < class grid_t > class GMM : public EikonalSolver <grid_t> {
                 const size_t narrow_size = gamma_.size();
                 i = gamma_.begin();
                 for(size_t z = 0; z < narrow_size; ++z) {//for each gamma in the forward order
-                    if( grid_->getCell(*i).getArrivalTime()<= tm_) {
-                        n_neighs = grid_->getNeighbors(*i, neighbors_);
+                    if( (*grid_)[*i].getArrivalTime()<= tm_) {
+                        n_neighs = solveNeighbors(*i); // Not frozen nor obstacles (velocity = 0).
                         for (unsigned int s = 0; s < n_neighs; ++s) {// for each neighbor of gamma
                             j = neighbors_[s];
-                            if ((grid_->getCell(j).getState() == FMState::FROZEN) || grid_->getCell(j).isOccupied() || (grid_->getCell(j).getVelocity() == 0)) // If Frozen,obstacle or velocity = 0
-                                continue;
-                            else {
-                                double new_arrival_time = solveEikonal(j);
-                                if (new_arrival_time < grid_->getCell(j).getArrivalTime()) {
-                                        grid_->getCell(j).setArrivalTime(new_arrival_time);
-                                }
-                                if (grid_->getCell(j).getState() == FMState::OPEN){
-                                    gamma_.push_back(j);
-                                    grid_->getCell(j).setState(FMState::NARROW);
-                                }
+                            if (neighborTimes_[s] < (*grid_)[j].getArrivalTime()) {
+                                    (*grid_)[j].setArrivalTime(neighborTimes_[s]);
+                            }
+                            if ((*grid_)[j].getState() == FMState::OPEN){
+                                gamma_.push_back(j);
+                                (*grid_)[j].setState(FMState::NARROW);
                             }
                         }//for each neighbor of gamma
-                    grid_->getCell(*i).setState(FMState::FROZEN);
+                    (*grid_)[*i].setState(FMState::FROZEN);
                     if (*i == goal_idx_)
                         stopWavePropagation = true;
                     i = gamma_.erase(i);
@@ -164,6 +152,8 @@ template < class grid_t > class GMM : public EikonalSolver <grid_t> {
         using EikonalSolver<grid_t>::setup;
         using EikonalSolver<grid_t>::setup_;
         using EikonalSolver<grid_t>::neighbors_;
+        using EikonalSolver<grid_t>::solveNeighbors;
+        using EikonalSolver<grid_t>::neighborTimes_;
 
     private:
         /** \brief Global bound that determines the group of cells of gamma that will be updated in each step. */
@@ -173,7 +163,7 @@ template < class grid_t > class GMM : public EikonalSolver <grid_t> {
         double                  deltau_;
         
         /** \brief List wich stores the narrow band of each iteration. */
-        std::list<unsigned int> gamma_;
+        std::list<index_t>      gamma_;
 };
 
 #endif /* GMM_H_*/
@@ -40,6 +40,9 @@
 template < class grid_t > class LSM : public FSM<grid_t> {
 
     public:
+        typedef typename FSM<grid_t>::index_t index_t;
+        typedef typename FSM<grid_t>::value_t value_t;
+
         LSM(unsigned maxSweeps = std::numeric_limits<unsigned>::max()) : FSM<grid_t>("LSM", maxSweeps) {}
 
         LSM(const char * name, unsigned maxSweeps = std::numeric_limits<unsigned>::max()) : FSM<grid_t>(name, maxSweeps) {}
@@ -55,14 +58,14 @@ template < class grid_t > class LSM : public FSM<grid_t> {
             // setEnvironment it can affect other planners run in the same
             // grid.
             for(size_t i = 0; i < grid_->size(); ++i)
-                grid_->getCell(i).setState(FMState::FROZEN);
+                (*grid_)[i].setState(FMState::FROZEN);
 
             // Initialization
-            for (unsigned int i: init_points_) {
-                grid_->getCell(i).setArrivalTime(0);
+            for (index_t i: init_points_) {
+                (*grid_)[i].setArrivalTime(0);
                 unsigned int n_neighs = grid_->getNeighbors(i, neighbors_);
                 for (unsigned int j = 0; j < n_neighs; ++j)
-                    grid_->getCell(neighbors_[j]).setState(FMState::OPEN);
+                    (*grid_)[neighbors_[j]].setState(FMState::OPEN);
             }
 
             // Getting dimsizes and filling the other dimensions.
@@ -81,7 +84,7 @@ template < class grid_t > class LSM : public FSM<grid_t> {
         () {
             FSM<grid_t>::reset();
             for(size_t i = 0; i < grid_->size(); ++i)
-                grid_->getCell(i).setState(FMState::FROZEN);
+                (*grid_)[i].setState(FMState::FROZEN);
         }
 
         virtual void printRunInfo
@@ -94,30 +97,69 @@ template < class grid_t > class LSM : public FSM<grid_t> {
         }
 
     protected:
-        /** \brief Actually executes one solving iteration of the LSM. */
-        virtual void solveForIdx
-        (unsigned idx) {
-            if (grid_->getCell(idx).getState() == FMState::OPEN) {
-                const double prevTime = grid_->getCell(idx).getArrivalTime();
-                const double newTime = solveEikonal(idx);
-
-                // Update time if better and unlock neighbors with higher time.
-                if(utils::isTimeBetterThan(newTime, prevTime)) {
-                    grid_->getCell(idx).setArrivalTime(newTime);
-                    keepSweeping_ = true;
-                    unsigned int n_neighs = grid_->getNeighbors(idx, neighbors_);
-                    for (unsigned int i = 0; i < n_neighs; ++i)
-                        if (utils::isTimeBetterThan(newTime, grid_->getCell(neighbors_[i]).getArrivalTime()))
-                            grid_->getCell(neighbors_[i]).setState(FMState::OPEN);
+        /** \brief Only the free cells unlocked are solved. If there are none, the row is not
+            swept: locked cells can only be unlocked by another cell of the row. */
+        virtual unsigned int selectRowCells
+        () {
+            unsigned int nsolve = 0;
+            for (unsigned int k = 0; k < row_.size(); ++k) {
+                rowSolve_[k] = rowFree_[k] && rowOpen_[k];
+                nsolve += rowSolve_[k];
+            }
+            return nsolve;
+        }
+
+        /** \brief Executes one solving iteration of the LSM for every cell of the row, in order.
+            Locked cells can only be unlocked during the sweep of the row by the previous cell.
+            In that case they were not selected and they are solved as in solveForIdx(), as all
+            the cells if candidates is false. */
+        virtual void solveRow
+        (bool candidates) {
+            bool updated = false; // Previous cell updated in this sweep.
+            for (unsigned int k = 0; k < row_.size(); ++k) {
+                const index_t idx = row_[k];
+                if (!rowSolve_[k] && !(updated && rowFree_[k] && (*grid_)[idx].getState() == FMState::OPEN)) {
+                    updated = false;
+                    continue;
                 }
-                // EXPERIMENTAL - Value not updated, it has converged
-                else if(!std::isnan(newTime) && !std::isinf(newTime) && (idx == goal_idx_))
-                    stopPropagation_ = true;
+                double newTime;
+                if (!rowSolve_[k] || !candidates)
+                    newTime = solveEikonal(idx);
+                else
+                    newTime = updated ? solveRowEikonal(k) : rowCandidate_[k];
+                updated = updateAndUnlock(idx, rowT_[k+1], newTime);
+                if (updated) {
+                    rowT_[k+1] = value_t(newTime);
+                    // The neighbor in the next row, already gathered, may have been unlocked.
+                    if (utils::isTimeBetterThan<value_t>(newTime, rowNextT_[k+1]))
+                        rowNextOpen_[k] = true;
+                }
+                (*grid_)[idx].setState(FMState::FROZEN);
+            }
+        }
 
-                grid_->getCell(idx).setState(FMState::FROZEN);
+        /** \brief Actually executes one solving iteration of the LSM. */
+        virtual void solveForIdx
+        (index_t idx) {
+            if ((*grid_)[idx].getState() == FMState::OPEN) {
+                updateAndUnlock(idx, (*grid_)[idx].getArrivalTime(), solveEikonal(idx));
+                (*grid_)[idx].setState(FMState::FROZEN);
             }
         }
 
+        /** \brief Sets newTime to the cell idx if it is better than prevTime, its current time,
+            and unlocks its neighbors with higher time. Returns true if it was updated. */
+        bool updateAndUnlock
+        (index_t idx, double prevTime, double newTime) {
+            if (!updateArrivalTime(idx, prevTime, newTime))
+                return false;
+            unsigned int n_neighs = grid_->getNeighbors(idx, neighbors_);
+            for (unsigned int i = 0; i < n_neighs; ++i)
+                if (utils::isTimeBetterThan<value_t>(newTime, (*grid_)[neighbors_[i]].getArrivalTime()))
+                    (*grid_)[neighbors_[i]].setState(FMState::OPEN);
+            return true;
+        }
+
         // Inherited members from FSM.
         using FSM<grid_t>::grid_;
         using FSM<grid_t>::init_points_;
@@ -136,10 +178,19 @@ template < class grid_t > class LSM : public FSM<grid_t> {
         using FSM<grid_t>::incs_;
         using FSM<grid_t>::inits_;
         using FSM<grid_t>::ends_;
-        using FSM<grid_t>::d_;
+        using FSM<grid_t>::row_;
+        using FSM<grid_t>::rowFree_;
+        using FSM<grid_t>::rowSolve_;
+        using FSM<grid_t>::rowOpen_;
+        using FSM<grid_t>::rowNextOpen_;
+        using FSM<grid_t>::rowNextT_;
+        using FSM<grid_t>::rowT_;
+        using FSM<grid_t>::rowCandidate_;
+        using FSM<grid_t>::solveRowEikonal;
+        using FSM<grid_t>::updateArrivalTime;
 
         /** \brief Auxiliar array which stores the neighbor of each iteration of the computeFM() function. */
-        std::array <unsigned int, 2*grid_t::getNDims()> neighbors_;
+        std::array <index_t, 2*grid_t::getNDims()> neighbors_;
 };
 
 #endif /* LSM_HPP_*/
@@ -41,7 +41,7 @@
 #include <fast_methods/ndgridmap/fmcell.h>
 #include <fast_methods/datastructures/fmpriorityqueue.hpp>
 
-template < class grid_t, class cell_t = FMCell>  class SFMM : public FMM<grid_t, FMPriorityQueue<cell_t>> {
+template < class grid_t, class cell_t = typename grid_t::cell_t>  class SFMM : public FMM<grid_t, FMPriorityQueue<cell_t>> {
 
     /** \brief Shorthand for base solver. */
     typedef FMM<grid_t, FMPriorityQueue<cell_t>> FMMBase;
@@ -49,6 +49,21 @@ template < class grid_t, class cell_t = FMCell>  class SFMM : public FMM<grid_t,
     public:
         SFMM(HeurStrategy h = NOHEUR) : FMMBase("SFMM", h) {}
         SFMM(const char * name, HeurStrategy h = NOHEUR) : FMMBase(name, h){}
+
+        /** \brief Also prints the number of stale entries (cells pushed again by increase())
+            discarded by the priority queue. */
+        virtual void printRunInfo
+        () const {
+            console::info("Simplified Fast Marching Method");
+            std::cout << '\t' << name_ << '\n'
+                      << '\t' << "Heuristic type: " << FMMBase::getHeuristics() << '\n'
+                      << '\t' << "Stale pops: " << FMMBase::getNarrowBand().getStalePops() << '\n'
+                      << '\t' << "Elapsed time: " << time_ << " ms\n";
+        }
+
+    protected:
+        using FMMBase::name_;
+        using FMMBase::time_;
 };
 
 #endif /* SFMM_HPP_*/
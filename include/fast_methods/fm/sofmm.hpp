@@ -0,0 +1,187 @@
+/*! \class SOFMM
+    \brief Implements the second order Fast Marching Method (SOFMM).
+
+    Same algorithm as FMM, but the Eikonal equation is discretized with second order
+    upwind differences in the dimensions in which the two upwind cells are frozen:
+
+        (3T - 4T1 + T2) / 2h   instead of   (T - T1) / h
+
+    being T1 the neighbor cell and T2 the next one in the same direction. Otherwise (close
+    to the initial points, obstacles or borders of the grid) the first order difference is
+    used, as in FMM. The same accuracy is achieved with coarser grids, which are much faster
+    to solve, specially in 3D.
+
+    As in FMM, any heap can be used (FMDaryHeap by default) and heuristics are supported.
+    With setFactored(), the cells within the factored radius are solved with the first order
+    factored scheme of EikonalSolver, exact in uniform maps, and the rest with second order.
+
+    @par External documentation:
+        J.A. Sethian, Level Set Methods and Fast Marching Methods, Cambridge University Press, 1999.
+
+        J. Rickett and S. Fomel, A second-order fast marching eikonal solver, Stanford Exploration
+        Project Report 100, 1999.
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOFMM_HPP_
+#define SOFMM_HPP_
+
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include <fast_methods/fm/fmm.hpp>
+
+#include <fast_methods/ndgridmap/fmcell.h>
+#include <fast_methods/datastructures/fmdaryheap.hpp>
+
+template < class grid_t, class heap_t = FMDaryHeap<typename grid_t::cell_t> >  class SOFMM : public FMM<grid_t, heap_t> {
+
+    /** \brief Shorthand for base solver. */
+    typedef FMM<grid_t, heap_t> FMMBase;
+
+    /** \brief Upwind term of the Eikonal equation in one dimension: alpha (T - Tbar)^2. */
+    struct Upwind {
+        /** \brief Value of the upwind neighbor, which sets the order the dimensions are added. */
+        double T1;
+
+        /** \brief 1 for first order, 9/4 for second order. */
+        double alpha;
+
+        /** \brief T1 for first order, (4 T1 - T2)/3 for second order. */
+        double Tbar;
+    };
+
+    public:
+        typedef typename FMMBase::index_t index_t;
+
+        SOFMM(HeurStrategy h = NOHEUR) : FMMBase("SOFMM", h) {}
+        SOFMM(const char * name, HeurStrategy h = NOHEUR) : FMMBase(name, h) {}
+
+        /** \brief Executes FMM setup and stores the dimensions of the grid, required to check
+            that the cells two positions upwind exist. */
+        virtual void setup
+        () {
+            FMMBase::setup();
+            dimsize_ = grid_->getDimSizes();
+        }
+
+        /** \brief Solves the Eikonal equation for cell idx with second order upwind differences
+            where possible, first order otherwise. If the second order solution is not upwind
+            (lower than a neighbor used), EikonalSolver::solveEikonal() is returned. The factored
+            scheme is used instead where it applies (see EikonalSolver::setFactored()). */
+        virtual double solveEikonal
+        (index_t idx) {
+            double factoredT;
+            if (this->isFactored() && solveFactoredEikonal(idx, factoredT))
+                return factoredT;
+
+            const double inf = std::numeric_limits<double>::infinity();
+            const double T = (*grid_)[idx].getArrivalTime();
+            std::array<unsigned int, grid_t::getNDims()> coords;
+            grid_->idx2coord(idx, coords);
+
+            unsigned int a = 0;
+            for (unsigned int dim = 0; dim < grid_t::getNDims(); ++dim) {
+                double T1 = inf;
+                double T2 = inf;
+                for (int dir = -1; dir <= 1; dir += 2) {
+                    if ((dir < 0 && coords[dim] < 1) || (dir > 0 && coords[dim] + 1 >= dimsize_[dim]))
+                        continue;
+                    const index_t n1 = grid_->step(idx, dim, dir);
+                    const double t1 = (*grid_)[n1].getArrivalTime();
+                    if (!(t1 < T1))
+                        continue;
+                    T1 = t1;
+                    T2 = inf;
+                    // Second order only with the two upwind cells frozen (their values are final).
+                    if ((*grid_)[n1].getState() != FMState::FROZEN ||
+                        (dir < 0 && coords[dim] < 2) || (dir > 0 && coords[dim] + 2 >= dimsize_[dim]))
+                        continue;
+                    const index_t n2 = grid_->step(n1, dim, dir);
+                    if ((*grid_)[n2].getState() == FMState::FROZEN && (*grid_)[n2].getArrivalTime() <= t1)
+                        T2 = (*grid_)[n2].getArrivalTime();
+                }
+                if (!(T1 < T))
+                    continue;
+
+                // Insertion sort by T1.
+                unsigned int i = a++;
+                for (; i > 0 && upwind_[i-1].T1 > T1; --i)
+                    upwind_[i] = upwind_[i-1];
+                if (std::isinf(T2))
+                    upwind_[i] = {T1, 1, T1};
+                else
+                    upwind_[i] = {T1, 2.25, (4*T1 - T2)/3};
+            }
+
+            if (a == 0)
+                return inf;
+
+            double t, tt;
+            getCrossingTimes(idx, t, tt);
+
+            // sum alpha_i (T - Tbar_i)^2 = tt, adding dimensions while the solution is higher
+            // than the next neighbor value.
+            double A = 0, B = 0, C = 0;
+            double updatedT = inf;
+            for (unsigned int i = 0; i < a; ++i) {
+                A += upwind_[i].alpha;
+                B += upwind_[i].alpha * upwind_[i].Tbar;
+                C += upwind_[i].alpha * upwind_[i].Tbar * upwind_[i].Tbar;
+                const double quad_term = B*B - A*(C - tt);
+                if (quad_term < 0)
+                    break;
+                updatedT = (B + std::sqrt(quad_term))/A;
+                if (i + 1 == a || updatedT <= upwind_[i+1].T1)
+                    break;
+            }
+
+            if (!(updatedT >= upwind_[0].T1))
+                return EikonalSolver<grid_t>::solveEikonal(idx);
+            return updatedT;
+        }
+
+        /** \brief The fused first order kernel does not apply: every neighbor is solved with
+            solveEikonal(). */
+        virtual unsigned int solveNeighbors
+        (index_t idx) {
+            return EikonalSolver<grid_t>::solveNeighborsByCell(idx);
+        }
+
+        virtual void printRunInfo
+        () const {
+            console::info("Second Order Fast Marching Method");
+            std::cout << '\t' << name_ << '\n'
+                      << '\t' << "Heuristic type: " << FMMBase::getHeuristics() << '\n'
+                      << '\t' << "Elapsed time: " << time_ << " ms\n";
+        }
+
+    protected:
+        using FMMBase::grid_;
+        using FMMBase::name_;
+        using FMMBase::time_;
+        using EikonalSolver<grid_t>::getCrossingTimes;
+        using EikonalSolver<grid_t>::solveFactoredEikonal;
+
+        /** \brief Upwind terms of the dimensions used, sorted by their neighbor value. */
+        std::array<Upwind, grid_t::getNDims()> upwind_;
+
+        /** \brief Size of each dimension of the grid. */
+        std::array<unsigned int, grid_t::getNDims()> dimsize_;
+};
+
+#endif /* SOFMM_HPP_*/
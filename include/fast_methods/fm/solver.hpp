@@ -30,6 +30,7 @@
 #include <fstream>
 #include <array>
 #include <chrono>
+#include <memory>
 
 #include <boost/concept_check.hpp>
 
@@ -40,6 +41,12 @@ template <class grid_t>
 class Solver {
 
     public:
+        /** \brief Shorthand for the index type of the grid. */
+        typedef typename grid_t::index_t index_t;
+
+        /** \brief Shorthand for the type in which the grid stores times (see utils::isTimeBetterThan()). */
+        typedef typename grid_t::value_t value_t;
+
         Solver() :name_("GenericSolver"), setup_(false) {}
 
         Solver(const std::string& name) : name_(name), setup_(false) {}
@@ -53,16 +60,29 @@ class Solver {
             grid_->clean();
         }
 
+        /** \brief Sets as environment a copy of map owned by the solver, so that map is not
+            modified and several solvers can use it at the same time. With FMCellShared cells
+            the copy only allocates the state of the cells and shares the velocities of map.
+            The copy is reused by the following calls, use reset() between queries. */
+        void setEnvironment
+        (const grid_t & map) {
+            if (ownGrid_)
+                *ownGrid_ = map;
+            else
+                ownGrid_.reset(new grid_t(map));
+            setEnvironment(ownGrid_.get());
+        }
+
         /** \brief Sets the initial and goal points by the indices of the grid. */
         virtual void setInitialAndGoalPoints
-        (const std::vector<unsigned int> & init_points, unsigned int goal_idx) {
+        (const std::vector<index_t> & init_points, index_t goal_idx) {
             init_points_ = init_points;
             goal_idx_ = goal_idx;
         }
 
         /** \brief Sets the initial points by the indices of the grid. */
         virtual void setInitialPoints
-        (const std::vector<unsigned int> & init_points)
+        (const std::vector<index_t> & init_points)
         {
             setInitialAndGoalPoints(init_points, -1);
         }
@@ -70,8 +90,8 @@ class Solver {
         /** \brief Sets the initial and goal points by the coordinates of the grid. */
         virtual void setInitialAndGoalPoints
         (const std::array<unsigned int, grid_t::getNDims()> & init_coord, const std::array<unsigned int, grid_t::getNDims()> & goal_coord) {
-            std::vector<unsigned int> init_points;
-            unsigned int idx;
+            std::vector<index_t> init_points;
+            index_t idx;
             grid_->coord2idx(init_coord, idx);
             init_points.push_back(idx);
             grid_->coord2idx(goal_coord, idx);
@@ -82,8 +102,8 @@ class Solver {
         virtual void setInitialPoints
         (const std::array<unsigned int, grid_t::getNDims()> & init_coord)
         {
-            std::vector<unsigned int> init_points;
-            unsigned int idx;
+            std::vector<index_t> init_points;
+            index_t idx;
             grid_->coord2idx(init_coord, idx);
             init_points.push_back(idx);
             setInitialAndGoalPoints(init_points, -1);
@@ -124,10 +144,13 @@ class Solver {
             setup_ = true;
         }
 
-        /** \brief Computes the distances map. Will call setup() if not done already. */
+        /** \brief Computes the distances map. Will call setup() if not done already. The
+            precomputed slowness of the grid, if outdated, is updated first (and timed). */
         void compute
         () {
             start_ = std::chrono::steady_clock::now();
+            if (grid_)
+                grid_->updateSlowness();
             computeInternal();
             end_ = std::chrono::steady_clock::now();
             time_ = std::chrono::duration_cast<std::chrono::milliseconds>(end_-start_).count();
@@ -205,12 +228,12 @@ class Solver {
             // When more that 1 initial point is given, this check is ommitted
             // since it could be FM2-like velocities map computation.
             if (init_points_.size() == 1 &&
-                grid_->getCell(init_points_[0]).isOccupied()) return 4;
+                (*grid_)[init_points_[0]].isOccupied()) return 4;
 
-            if(int(goal_idx_) != -1 && grid_->getCell(goal_idx_).isOccupied()) return 5;
+            if(goal_idx_ != index_t(-1) && (*grid_)[goal_idx_].isOccupied()) return 5;
 
-            for (int ip : init_points_)
-                if(int(goal_idx_) == ip) return 6;
+            for (index_t ip : init_points_)
+                if(goal_idx_ == ip) return 6;
 
             return 0;
         }
@@ -218,6 +241,9 @@ class Solver {
         /** \brief Grid container. */
         grid_t*                     grid_;
 
+        /** \brief Grid owned by the solver, set by setEnvironment(const grid_t &). */
+        std::unique_ptr<grid_t>     ownGrid_;
+
         /** \brief Solver name. */
         std::string                 name_;
 
@@ -225,10 +251,10 @@ class Solver {
         bool                        setup_;
 
         /** \brief Initial index. */
-        std::vector<unsigned int>   init_points_;
+        std::vector<index_t>        init_points_;
 
         /** \brief Goal index. */
-        unsigned int                goal_idx_;
+        index_t                     goal_idx_;
 
         /** \brief Time measurement variables. */
         std::chrono::time_point<std::chrono::steady_clock> start_, end_;
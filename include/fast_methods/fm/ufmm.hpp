@@ -6,6 +6,14 @@
 
     The grid is assumed to be squared, that is Delta(x) = Delta(y) = leafsize_
 
+    The untidy queue is configured in setup() unless given in the constructor: the width of
+    the buckets is a tenth of the minimum increment of the arrival time between neighbor cells,
+    leafsize/(maxSpeed*sqrt(ndims)), and the maximum increment is the widest possible narrow
+    band, leafsize/minSpeed. Cells are accepted out of order only within a bucket, so the
+    difference with FMM is a small fraction of the time to cross a cell. With setAdaptive(true), the narrow band is assumed to be only
+    leafsize/avgSpeed wide and buckets are added during propagation when needed, which
+    requires less memory in maps with few very slow cells.
+
     @par External documentation:
         L. Yatziv, A.Bartesaghi and G. Sapiro, O(n) implementation of the fast marching algorithm, Journal of Computational Physics. 212(2): 393-399. 2006.
         <a href="http://www.sciencedirect.com/science/article/pii/S0021999105003736">[PDF]</a>
@@ -31,64 +39,101 @@
 #ifndef UFMM_HPP_
 #define UFMM_HPP_
 
+#include <algorithm>
+#include <cmath>
+
 #include <fast_methods/fm/eikonalsolver.hpp>
 #include <fast_methods/datastructures/fmuntidyqueue.hpp>
 
-template <class grid_t, class cell_t = FMCell> class UFMM : public EikonalSolver<grid_t> {
+template <class grid_t, class cell_t = typename grid_t::cell_t> class UFMM : public EikonalSolver<grid_t> {
 
     public:
+        typedef typename EikonalSolver<grid_t>::index_t index_t;
+        typedef typename EikonalSolver<grid_t>::value_t value_t;
+
+        /** \brief Creates a UFMM with s buckets and maximum increment inc. Any of them is computed
+            from the grid in setup() if 0. */
         UFMM
-        (unsigned s = 1000, double inc = 2) : EikonalSolver<grid_t>("UFMM"), heap_s_(s), heap_inc_(inc) {
-            narrow_band_ = new FMUntidyQueue<cell_t> (heap_s_, heap_inc_);
+        (unsigned s = 0, double inc = 0, bool adaptive = false) : EikonalSolver<grid_t>("UFMM"), heap_s_(s), heap_inc_(inc) {
+            narrow_band_ = new FMUntidyQueue<cell_t> ();
+            narrow_band_->setAdaptive(adaptive);
         }
         UFMM
-        (const char * name, unsigned s = 1000, double inc = 2) : EikonalSolver<grid_t>(name), heap_s_(s), heap_inc_(inc) {
-            narrow_band_ = new FMUntidyQueue<cell_t> (heap_s_, heap_inc_);
+        (const char * name, unsigned s = 0, double inc = 0, bool adaptive = false) : EikonalSolver<grid_t>(name), heap_s_(s), heap_inc_(inc) {
+            narrow_band_ = new FMUntidyQueue<cell_t> ();
+            narrow_band_->setAdaptive(adaptive);
         }
 
         virtual ~UFMM() { clear(); }
 
+        /** \brief Executes EikonalSolver setup, sets maximum size for the narrow band and
+            configures its buckets (see class description). */
+        virtual void setup
+        () {
+            EikonalSolver<grid_t>::setup();
+            narrow_band_->setMaxSize(grid_->size());
+
+            double inc = heap_inc_;
+            unsigned s = heap_s_;
+            const double h = grid_->getLeafSize();
+            const double width = h / (10 * grid_->getMaxSpeed() * std::sqrt(grid_t::getNDims()));
+            if (inc <= 0)
+                inc = h / (narrow_band_->isAdaptive() ? grid_->getAvgSpeed() : grid_->getMinSpeed()) + 2*width;
+            if (s == 0 && std::isfinite(inc/width))
+                s = static_cast<unsigned>(std::min(std::ceil(inc/width), double(std::max<size_t>(grid_->size(), 2))));
+            if (!std::isfinite(inc) || s == 0) {
+                console::warning("UFMM: the buckets cannot be computed from the grid speeds, using 1000 buckets and maximum increment 2.");
+                inc = 2;
+                s = 1000;
+            }
+            narrow_band_->setBuckets(s, inc);
+        }
+
+        /** \brief If true, buckets are added to the untidy queue during propagation when needed
+            (see FMUntidyQueue::setAdaptive()). */
+        void setAdaptive
+        (bool a) {
+            narrow_band_->setAdaptive(a);
+            setup_ = false;
+        }
+
         /** \brief Actual method that implements UFMM. */
         virtual void computeInternal
         () {
             if (!setup_)
                 setup();
 
-            unsigned int j= 0;
+            index_t j= 0;
             unsigned int n_neighs = 0;
             bool stopWavePropagation = false;
 
             // Algorithm initialization
-            for (unsigned int &i : init_points_) { // For each initial point
-                grid_->getCell(i).setArrivalTime(0);
-                narrow_band_->push( &(grid_->getCell(i)) );
+            for (index_t &i : init_points_) { // For each initial point
+                (*grid_)[i].setArrivalTime(0);
+                narrow_band_->push( (*grid_)[i] );
             }
 
             // Main loop.
-            unsigned int idxMin = 0;
+            index_t idxMin = 0;
             while (!stopWavePropagation && !narrow_band_->empty()) {
                 idxMin = narrow_band_->topIdx(); // pop() has to be called after pushing in this case (because
                                                  // of the untidy queue implementation.
-                grid_->getCell(idxMin).setState(FMState::FROZEN);
-                n_neighs = grid_->getNeighbors(idxMin, neighbors_);
+                (*grid_)[idxMin].setState(FMState::FROZEN);
+                n_neighs = solveNeighbors(idxMin); // Neighbors not frozen nor occupied.
                 for (unsigned int s = 0; s < n_neighs; ++s) { // For each neighbor.
                     j = neighbors_[s];
-                    if ( (grid_->getCell(j).getState() == FMState::FROZEN) || grid_->getCell(j).isOccupied())
-                        continue;
-                    else {
-                        double new_arrival_time = solveEikonal(j);
-                        if (grid_->getCell(j).getState() == FMState::NARROW) { // Updating narrow band if necessary.
-                            if (utils::isTimeBetterThan(new_arrival_time, grid_->getCell(j).getArrivalTime()) ) {
-                                grid_->getCell(j).setArrivalTime(new_arrival_time);
-                                narrow_band_->increase( &(grid_->getCell(j)) );
-                            }
+                    const double new_arrival_time = neighborTimes_[s];
+                    if ((*grid_)[j].getState() == FMState::NARROW) { // Updating narrow band if necessary.
+                        if (utils::isTimeBetterThan<value_t>(new_arrival_time, (*grid_)[j].getArrivalTime()) ) {
+                            (*grid_)[j].setArrivalTime(new_arrival_time);
+                            narrow_band_->increase( (*grid_)[j] );
                         }
-                        else {
-                            grid_->getCell(j).setState(FMState::NARROW);
-                            grid_->getCell(j).setArrivalTime(new_arrival_time);
-                            narrow_band_->push( &(grid_->getCell(j)) );
-                        } // neighbors open.
-                    } // neighbors not frozen.
+                    }
+                    else {
+                        (*grid_)[j].setState(FMState::NARROW);
+                        (*grid_)[j].setArrivalTime(new_arrival_time);
+                        narrow_band_->push( (*grid_)[j] );
+                    } // neighbors open.
                 } // For each neighbor.
                 narrow_band_->pop();
                 if (idxMin == goal_idx_)
@@ -100,8 +145,9 @@ template <class grid_t, class cell_t = FMCell> class UFMM : public EikonalSolver
         () const {
             console::info("Untidy Fast Marching Method");
             std::cout << '\t' << name_ << '\n'
-                      << '\t' << "Number of buckets: " << heap_s_ << '\n'
-                      << '\t' << "Maximum increment " << heap_inc_ << '\n'
+                      << '\t' << "Number of buckets: " << narrow_band_->getNBuckets() << '\n'
+                      << '\t' << "Maximum increment " << narrow_band_->getMaxIncrement() << '\n'
+                      << '\t' << "Adaptive buckets: " << narrow_band_->isAdaptive() << '\n'
                       << '\t' << "Elapsed time: " << time_ << " ms\n";
         }
 
@@ -121,17 +167,18 @@ template <class grid_t, class cell_t = FMCell> class UFMM : public EikonalSolver
         using EikonalSolver<grid_t>::solveEikonal;
         using EikonalSolver<grid_t>::init_points_;
         using EikonalSolver<grid_t>::goal_idx_;
-        using EikonalSolver<grid_t>::setup;
         using EikonalSolver<grid_t>::setup_;
         using EikonalSolver<grid_t>::neighbors_;
+        using EikonalSolver<grid_t>::solveNeighbors;
+        using EikonalSolver<grid_t>::neighborTimes_;
         using EikonalSolver<grid_t>::name_;
         using EikonalSolver<grid_t>::time_;
 
     private:
-        /** \brief Number of buckets in the heap. */
+        /** \brief Number of buckets in the heap, 0 to compute it in setup(). */
         unsigned                heap_s_;
 
-        /** \brief Size (maximum increment) of the heap. */
+        /** \brief Size (maximum increment) of the heap, 0 to compute it in setup(). */
         double                  heap_inc_;
 
         /** \brief Heap Instance of the priority queue used. */
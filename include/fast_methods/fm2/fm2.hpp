@@ -46,9 +46,11 @@
 /// \todo Include support to other solvers (GMM, FIM, UFMM). It requires a better way of setting parameters.
 //template < class grid_t, class solver_t = FMM<grid_t> > class FM2 : public Solver<grid_t> {
 
-template < class grid_t, class heap_t = FMDaryHeap<FMCell> > class FM2 : public Solver<grid_t> {
+template < class grid_t, class heap_t = FMDaryHeap<typename grid_t::cell_t> > class FM2 : public Solver<grid_t> {
     public:
-    
+        typedef typename Solver<grid_t>::index_t index_t;
+        using Solver<grid_t>::setEnvironment;
+
         /** \brief Path type encapsulation. */
         typedef std::vector< std::array<double, grid_t::getNDims()> > path_t;
 
@@ -102,9 +104,9 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> > class FM2 : public
             start_ = std::chrono::steady_clock::now();
 
             // According to the theoretical basis the wave is expanded from the goal point to the initial point.
-            std::vector <unsigned int> wave_init;
+            std::vector <index_t> wave_init;
             wave_init.push_back(goal_idx_);
-            unsigned int wave_goal = init_points_[0];
+            index_t wave_goal = init_points_[0];
 
             solver_->setInitialAndGoalPoints(wave_init, wave_goal);
             solver_->compute();
@@ -129,22 +131,27 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> > class FM2 : public
             if (maxDistance_ != -1)
                 maxVelocity = maxDistance_ / grid_->getLeafSize();
 
-            for (unsigned int i = 0; i < grid_->size(); ++i) {
-                double vel = grid_->getCell(i).getValue() / maxValue;
-
-                if (maxDistance_ != -1)
-                    if (vel < maxVelocity)
-                        grid_->getCell(i).setVelocity(vel / maxVelocity);
+            for (index_t i = 0; i < grid_->size(); ++i) {
+                // Obstacles (sources of the first wave) keep velocity 0. It also
+                // preserves the ghost cells of padded grids.
+                if (!(*grid_)[i].isOccupied()) {
+                    double vel = (*grid_)[i].getValue() / maxValue;
+
+                    if (maxDistance_ != -1)
+                        if (vel < maxVelocity)
+                            (*grid_)[i].setVelocity(vel / maxVelocity);
+                        else
+                            (*grid_)[i].setVelocity(1);
                     else
-                        grid_->getCell(i).setVelocity(1);
-                else
-                    grid_->getCell(i).setVelocity(vel);
+                        (*grid_)[i].setVelocity(vel);
+                }
 
                 // Restarting grid values for second wave expasion.
-                grid_->getCell(i).setValue(std::numeric_limits<double>::infinity());
-                grid_->getCell(i).setState(FMState::OPEN);
+                (*grid_)[i].setValue(std::numeric_limits<double>::infinity());
+                (*grid_)[i].setState(FMState::OPEN);
                 grid_->setClean(true);
             }
+            grid_->setSpeedsModified();
             end_ = std::chrono::steady_clock::now();
             time_vels_ += std::chrono::duration_cast<std::chrono::milliseconds>(end_-start_).count();
         }
@@ -160,7 +167,7 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> > class FM2 : public
         virtual void computePath
         (path_t * p, std::vector <double> * path_velocity, double step = 1) {
             path_t* path_ = p;
-            GradientDescent< nDGridMap<FMCell, grid_t::getNDims()> > grad;
+            GradientDescent<grid_t> grad;
             grad.apply(*grid_,init_points_[0],*path_, *path_velocity, step);
         }
 
@@ -194,7 +201,7 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> > class FM2 : public
         using Solver<grid_t>::end_;
 
         /** \brief Wave propagation sources for the Fast Marching Square velocities map computation.*/
-        std::vector<unsigned int>   fm2_sources_;
+        std::vector<index_t>        fm2_sources_;
         
         /** \brief Underlying FMM-based solver. */
         FMM<grid_t, heap_t> *       solver_;
@@ -48,7 +48,7 @@
 /// \todo Include support to other solvers (GMM, FIM, UFMM). Requires theoretical work on heuristics on these methods.
 // template < class grid_t, class solver_t = FMM<grid_t> > class FM2Star : public FM2<grid_t> {
 
-template < class grid_t, class heap_t = FMDaryHeap<FMCell> > class FM2Star : public FM2<grid_t, heap_t> {
+template < class grid_t, class heap_t = FMDaryHeap<typename grid_t::cell_t> > class FM2Star : public FM2<grid_t, heap_t> {
 
     /** \brief Path type encapsulation. */
     typedef std::vector< std::array<double, grid_t::getNDims()> > path_t;
@@ -57,6 +57,8 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> > class FM2Star : pub
     typedef FM2<grid_t, heap_t > FM2Base;
 
     public:
+        typedef typename FM2Base::index_t index_t;
+
         /** \brief maxDistance sets the velocities map saturation distance in real units (before normalization). */
         FM2Star
         (HeurStrategy heurStrategy = TIME, double maxDistance = -1) : FM2Base("FM2*", maxDistance), heurStrategy_(heurStrategy) { }
@@ -67,7 +69,7 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> > class FM2Star : pub
 
         /** \brief Overloaded from FM2. In this case the precomputeDistances() method is called. */
         virtual void setInitialAndGoalPoints
-        (const std::vector<unsigned int> & init_points, unsigned int goal_idx) {
+        (const std::vector<index_t> & init_points, index_t goal_idx) {
             FM2Base::setInitialAndGoalPoints(init_points, goal_idx);
             solver_->precomputeDistances();
         }
@@ -76,7 +78,7 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> > class FM2Star : pub
         virtual void setup
         () {
             FM2Base::setup();
-            if(int(goal_idx_) == -1)
+            if(goal_idx_ == index_t(-1))
             {
                 console::error("A goal point has to be set for FM2-based solvers.");
                 exit(1);
@@ -95,9 +97,9 @@ template < class grid_t, class heap_t = FMDaryHeap<FMCell> > class FM2Star : pub
             start_ = std::chrono::steady_clock::now();
 
             // According to the theoretical basis the wave is expanded from the goal point to the initial point.
-            std::vector <unsigned int> wave_init;
+            std::vector <index_t> wave_init;
             wave_init.push_back(goal_idx_);
-            unsigned int wave_goal = init_points_[0];
+            index_t wave_goal = init_points_[0];
 
             solver_->setInitialAndGoalPoints(wave_init, wave_goal);
             solver_->setHeuristics(heurStrategy_);
@@ -46,6 +46,9 @@ template <class grid_t> class GradientDescent {
     /** \brief Shorthand for coordinates. */
     typedef typename std::array<unsigned int, ndims_> Coord;
 
+    /** \brief Shorthand for indices. */
+    typedef typename grid_t::index_t Index;
+
     /** \brief Shorhand for real points. */
     typedef typename std::array<double, ndims_> Point;
 
@@ -62,18 +65,14 @@ template <class grid_t> class GradientDescent {
            No checks are done (points in the borders, points in obstacles...).
            IMPORTANT NOTE: both minimum and initial index cannot be in the
            border of the map. This situation is not checked. We recommend to set a 1 pixel
-           black border around the map image. */
+           black border around the map image.
+
+           The grid is only read, so that several paths can be extracted in parallel from the same grid. */
       static void apply
-      (grid_t & grid, unsigned int & idx, Path & path, std::vector <double> & path_velocity, double step = 1) {
+      (const grid_t & grid, Index & idx, Path & path, std::vector <double> & path_velocity, double step = 1) {
 
           Coord current_coord;
           Point current_point;
-          Coord dimsize = grid.getDimSizes();
-
-          std::array<unsigned int, ndims_-1> d_; //  Same as nDGridMap class auxiliar array d_.
-          d_[0] = dimsize[0];
-          for (size_t i = 1; i < ndims_; ++i)
-              d_[i] = dimsize[i]*d_[i-1];
 
           grid.idx2coord(idx, current_coord);
           std::copy_n( current_coord.begin(), ndims_, current_point.begin() ); // Cast to int.
@@ -88,13 +87,13 @@ template <class grid_t> class GradientDescent {
               // (the path is composed by continuous points).
 
               // First dimension done apart.
-              grads[0] = - grid[idx-1].getValue()/2 + grid[idx+1].getValue()/2;
+              grads[0] = - grid[grid.step(idx, 0, -1)].getValue()/2 + grid[grid.step(idx, 0, 1)].getValue()/2;
               if (std::isinf(grads[0]))
                   grads[0] = sgn<double>(grads[0]);
               double max_grad = std::abs(grads[0]);
 
               for (size_t i = 1; i < ndims_; ++i) {
-                  grads[i] = - grid[idx-d_[i-1]].getValue()/2 + grid[idx+d_[i-1]].getValue()/2;
+                  grads[i] = - grid[grid.step(idx, i, -1)].getValue()/2 + grid[grid.step(idx, i, 1)].getValue()/2;
                   if (std::isinf(grads[i]))
                       grads[i] = sgn<double>(grads[i]);
                   if (std::abs(max_grad) < std::abs(grads[i]))
@@ -0,0 +1,83 @@
+/*! \file gridfile.hpp
+    \brief Binary grid file format, written by GridWriter::saveGridBinary() and read by
+    MapLoader::loadMapFromBinary().
+
+    All the fields are stored in the byte order of the machine (little endian on x86):
+    - GridFileHeader (40 bytes).
+    - dimsize[0], dimsize[1]... dimsize[ndims-1] (uint64_t each).
+    - Velocities of the cells in row-major order, first dimension changes fastest (double each).
+    - Row-major indices of the occupied cells (uint64_t each).
+
+    Every section is 8-byte aligned, so that the velocities can be used directly from a
+    memory mapping of the file (see FMCellMapped).
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRIDFILE_HPP_
+#define GRIDFILE_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+/** \brief Header of the binary grid files. */
+struct GridFileHeader {
+    /** \brief Version of the format written by this code. */
+    static constexpr uint32_t currentVersion = 1;
+
+    GridFileHeader() : version(currentVersion), ndims(0), ncells(0), nobs(0), leafsize(1) {
+        std::memcpy(magic, "FMGRID\0\0", 8);
+    }
+
+    /** \brief Returns true if the header was written by GridWriter::saveGridBinary(). */
+    bool isValid
+    () const {
+        return std::memcmp(magic, "FMGRID\0\0", 8) == 0 && version == currentVersion;
+    }
+
+    /** \brief Returns the offset in bytes of the velocities in the file. */
+    uint64_t velocitiesOffset
+    () const {
+        return sizeof(GridFileHeader) + ndims*sizeof(uint64_t);
+    }
+
+    /** \brief Returns the offset in bytes of the occupied cells in the file. */
+    uint64_t obstaclesOffset
+    () const {
+        return velocitiesOffset() + ncells*sizeof(double);
+    }
+
+    /** \brief "FMGRID" followed by two null characters. */
+    char        magic[8];
+
+    /** \brief Version of the format. */
+    uint32_t    version;
+
+    /** \brief Number of dimensions. */
+    uint32_t    ndims;
+
+    /** \brief Number of cells. */
+    uint64_t    ncells;
+
+    /** \brief Number of occupied cells. */
+    uint64_t    nobs;
+
+    /** \brief Real size of the cells. */
+    double      leafsize;
+};
+
+static_assert(sizeof(GridFileHeader) == 40, "GridFileHeader has to be 40 bytes long, without padding.");
+
+#endif /* GRIDFILE_HPP_*/
@@ -56,13 +56,13 @@ class GridPlotter {
             The Y dimension flipping is because nDGridMap works in X-Y coordinates, not in image indices as CImg.
 
             IMPORTANT NOTE: no type-checkings are done. T type has to be Cell or any class with bool getOccupancy() method. */
-        template<class T, size_t ndims> 
+        template<class T, size_t ndims, class L> 
         static void plotMap
-        (nDGridMap<T, ndims> & grid, std::string name = "") {
+        (nDGridMap<T, ndims, L> & grid, std::string name = "") {
             std::array<unsigned int,2> d = grid.getDimSizes();
             CImg<bool> img(d[0],d[1],1,1,0);
             // Filling the image flipping Y dim. We want now top left to be the (0,0).
-            cimg_forXY(img,x,y) {img(x,y) = !grid[img.width()*(img.height()-y-1)+x].isOccupied(); }
+            cimg_forXY(img,x,y) {img(x,y) = !grid[grid.rowMajor2idx(img.width()*(img.height()-y-1)+x)].isOccupied(); }
             // Code for not-inverted Y axis.
             //cimg_forXY(img,x,y) { if(grid[img.width()*y+x].getOccupancy() > 0.5) img(x,y) = true;
             //                      else img(x,y) = false; }
@@ -79,13 +79,13 @@ class GridPlotter {
             The Y dimension flipping is because nDGridMap works in X-Y coordinates, not in image indices as CImg.
 
             IMPORTANT NOTE: no type-checkings are done. T type has to be Cell or any class with bool getOccupancy() method. */
-        template<class T, size_t ndims>
+        template<class T, size_t ndims, class L>
         static void plotOccupancyMap
-        (nDGridMap<T, ndims> & grid, std::string name = "") {
+        (nDGridMap<T, ndims, L> & grid, std::string name = "") {
             std::array<unsigned int,2> d = grid.getDimSizes();
             CImg<double> img(d[0],d[1],1,1,0);
             // Filling the image flipping Y dim. We want now top left to be the (0,0).
-            cimg_forXY(img,x,y) { img(x,y) = grid[img.width()*(img.height()-y-1)+x].getOccupancy()*255; }
+            cimg_forXY(img,x,y) { img(x,y) = grid[grid.rowMajor2idx(img.width()*(img.height()-y-1)+x)].getOccupancy()*255; }
             name += " Occupancy Map";
             img.display(name.c_str(), false);
         }
@@ -99,14 +99,14 @@ class GridPlotter {
             The Y dimension flipping is because nDGridMap works in X-Y coordinates, not in image indices as CImg.
 
            IMPORTANT NOTE: no type-checkings are done. T type has to be Cell or any class with bool getValue() method. */
-        template<class T, size_t ndims = 2>
+        template<class T, size_t ndims = 2, class L>
         static void plotArrivalTimes
-        (nDGridMap<T, ndims> & grid, std::string name = "") {
+        (nDGridMap<T, ndims, L> & grid, std::string name = "") {
             std::array<unsigned int,2> d = grid.getDimSizes();
             double max_val = grid.getMaxValue();
             CImg<double> img(d[0],d[1],1,1,0);
             // Filling the image flipping Y dim. We want now top left to be the (0,0).
-            cimg_forXY(img,x,y) { img(x,y) = grid[img.width()*(img.height()-y-1)+x].getValue()/max_val*255; }
+            cimg_forXY(img,x,y) { img(x,y) = grid[grid.rowMajor2idx(img.width()*(img.height()-y-1)+x)].getValue()/max_val*255; }
             img.map( CImg<double>::jet_LUT256() );
             name += " Grid values";
             img.display(name.c_str(), false);
@@ -121,14 +121,14 @@ class GridPlotter {
             The Y dimension flipping is because nDGridMap works in X-Y coordinates, not in image indices as CImg.
 
             IMPORTANT NOTE: no type-checkings are done. T type has to be Cell or any class with bool getOccupancy() method. */
-        template<class T, size_t ndims = 2>
+        template<class T, size_t ndims = 2, class L>
         static void plotMapPath
-        (nDGridMap<T, ndims> & grid, const Path2D & path, std::string name = "") {
+        (nDGridMap<T, ndims, L> & grid, const Path2D & path, std::string name = "") {
             std::array<unsigned int,2> d = grid.getDimSizes();
             CImg<double> img(d[0],d[1],1,3,0);
 
             // Filling the image flipping Y dim. We want now top left to be the (0,0).
-            cimg_forXYZC(img,x,y,z,c) { img(x,y,z,c) = (!grid[img.width()*(img.height()-y-1)+x].isOccupied())*255; }
+            cimg_forXYZC(img,x,y,z,c) { img(x,y,z,c) = (!grid[grid.rowMajor2idx(img.width()*(img.height()-y-1)+x)].isOccupied())*255; }
 
             for (unsigned int i = 0; i< path.size(); ++i)
             {
@@ -149,13 +149,13 @@ class GridPlotter {
             The Y dimension flipping is because nDGridMap works in X-Y coordinates, not in image indices as CImg.
 
             IMPORTANT NOTE: no type-checkings are done. T type has to be Cell or any class with bool getOccupancy() method. */
-        template<class T, size_t ndims = 2>
+        template<class T, size_t ndims = 2, class L>
         static void plotOccupancyPath
-        (nDGridMap<T, ndims> & grid, const Path2D & path, std::string name = "") {
+        (nDGridMap<T, ndims, L> & grid, const Path2D & path, std::string name = "") {
             std::array<unsigned int,2> d = grid.getDimSizes();
             CImg<double> img(d[0],d[1],1,3,0);
             // Filling the image flipping Y dim. We want now top left to be the (0,0).
-            cimg_forXYZC(img,x,y,z,c) { img(x,y,z,c) = grid[img.width()*(img.height()-y-1)+x].getOccupancy()*255; }
+            cimg_forXYZC(img,x,y,z,c) { img(x,y,z,c) = grid[grid.rowMajor2idx(img.width()*(img.height()-y-1)+x)].getOccupancy()*255; }
 
             for (unsigned int i = 0; i< path.size(); ++i)
             {
@@ -175,14 +175,14 @@ class GridPlotter {
             The Y dimension flipping is because nDGridMap works in X-Y coordinates, not in image indices as CImg.
 
             IMPORTANT NOTE: no type-checkings are done. T type has to be Cell or any class with bool getOccupancy() method. */
-        template<class T, size_t ndims = 2>
+        template<class T, size_t ndims = 2, class L>
         static void plotMapPaths
-        (nDGridMap<T, ndims> & grid, const Paths2D & paths, std::string name = "") {
+        (nDGridMap<T, ndims, L> & grid, const Paths2D & paths, std::string name = "") {
             std::array<unsigned int,2> d = grid.getDimSizes();
             CImg<double> img(d[0],d[1],1,3,0);
 
             // Filling the image flipping Y dim. We want now top left to be the (0,0).
-            cimg_forXYZC(img,x,y,z,c) { img(x,y,z,c) = (!grid[img.width()*(img.height()-y-1)+x].isOccupied())*255; }
+            cimg_forXYZC(img,x,y,z,c) { img(x,y,z,c) = (!grid[grid.rowMajor2idx(img.width()*(img.height()-y-1)+x)].isOccupied())*255; }
 
             // Draw the path using different colours
             for (unsigned int j = 0; j < paths.size(); ++j)
@@ -207,15 +207,15 @@ class GridPlotter {
             The Y dimension flipping is because nDGridMap works in X-Y coordinates, not in image indices as CImg.
 
             IMPORTANT NOTE: no type-checkings are done. T type has to be Cell or any class with bool getOccupancy() method. */
-      template<class T, size_t ndims = 2>
+      template<class T, size_t ndims = 2, class L>
       static void plotArrivalTimesPath
-      (nDGridMap<T, ndims> & grid, const Path2D & path, std::string name = "") {
+      (nDGridMap<T, ndims, L> & grid, const Path2D & path, std::string name = "") {
           std::array<unsigned int,2> d = grid.getDimSizes();
           double max_val = grid.getMaxValue();
           CImg<double> img(d[0],d[1],1,1,0);
 
           // Filling the image flipping Y dim. We want now top left to be the (0,0).
-          cimg_forXY(img,x,y) { img(x,y) = grid[img.width()*(img.height()-y-1)+x].getValue()/max_val*255; }
+          cimg_forXY(img,x,y) { img(x,y) = grid[grid.rowMajor2idx(img.width()*(img.height()-y-1)+x)].getValue()/max_val*255; }
 
           for (unsigned int i = 0; i< path.size(); ++i)
               img(static_cast<unsigned int>(path[i][0]), (img.height()-static_cast<unsigned int>(path[i][1])-1)) = 255;
@@ -231,15 +231,15 @@ class GridPlotter {
            The Y dimension flipping is because nDGridMap works in X-Y coordinates, not in image indices as CImg.
 
           IMPORTANT NOTE: no type-checkings are done. T type has to be Cell or any class with bool getValue() method. */
-       template<class T, size_t ndims = 2>
+       template<class T, size_t ndims = 2, class L>
        static void plotFMStates
-       (nDGridMap<T, ndims> & grid, std::string name = "") {
+       (nDGridMap<T, ndims, L> & grid, std::string name = "") {
            std::array<unsigned int,2> d = grid.getDimSizes();
            //double max_val = grid.getMaxValue();
            CImg<unsigned int> img(d[0],d[1],1,1,0);
            // Filling the image flipping Y dim. We want now top left to be the (0,0).
            cimg_forXY(img,x,y) {
-               FMState state = grid[img.width()*(img.height()-y-1)+x].getState();
+               FMState state = grid[grid.rowMajor2idx(img.width()*(img.height()-y-1)+x)].getState();
                unsigned int val = 0;
                if (state == FMState::NARROW)
                    val = 127;
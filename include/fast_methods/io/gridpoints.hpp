@@ -50,18 +50,18 @@ class GridPoints {
             The Y dimension flipping is because nDGridMap works in X-Y coordinates, not in image indices as CImg.
 
            IMPORTANT NOTE: no type-checkings are done. T type has to be Cell or any class with bool getOccupancy() method. */
-        template<class T, size_t ndims> 
+        template<class T, size_t ndims, class L> 
         static void selectMapPoints
-        (nDGridMap<T, ndims> & grid, std::array<unsigned int,ndims> & coords_init, std::array<unsigned int,ndims> & coords_goal, const bool flipY = 1) {
+        (nDGridMap<T, ndims, L> & grid, std::array<unsigned int,ndims> & coords_init, std::array<unsigned int,ndims> & coords_goal, const bool flipY = 1) {
             unsigned int y = 0, x = 0;
             // TODO: image checking: B/W, correct reading, etc.
             std::array<unsigned int,2> d = grid.getDimSizes();
             CImg<double> img(d[0],d[1],1,1,0);
             if (flipY)
                 // Filling the image flipping Y dim. We want now top left to be the (0,0).
-                cimg_forXY(img,x,y) { img(x,y) = grid[img.width()*(img.height()-y-1)+x].getOccupancy()*255; }
+                cimg_forXY(img,x,y) { img(x,y) = grid[grid.rowMajor2idx(img.width()*(img.height()-y-1)+x)].getOccupancy()*255; }
             else 
-                cimg_forXY(img,x,y) { img(x,y) = grid[img.width()*y+x].getOccupancy(); }
+                cimg_forXY(img,x,y) { img(x,y) = grid[grid.rowMajor2idx(img.width()*y+x)].getOccupancy(); }
                 
             CImgDisplay main_disp(img,"Click a point");
 
@@ -21,8 +21,10 @@
 #define GRIDWRITER_H_
 
 #include <fstream>
+#include <vector>
 
 #include <fast_methods/ndgridmap/ndgridmap.hpp>
+#include <fast_methods/io/gridfile.hpp>
 
 // TODO: include checks which ensure that the grids are adecuate for the functions used.
 // TODO: there should be a check when writing grid: it is written already? erase and write. Something like that.
@@ -43,21 +45,21 @@ class GridWriter {
             getCell(ncells_-1).getValue()\n
 
             Use the parsegrid.m Matlab script to parse the data. */
-        template <class T, size_t ndims>
+        template <class T, size_t ndims, class L>
         static void saveGridValues
-        (const char * filename, nDGridMap<T, ndims> & grid) {
+        (const char * filename, nDGridMap<T, ndims, L> & grid) {
             std::ofstream ofs;
             ofs.open (filename,  std::ofstream::out | std::ofstream::trunc);
 
-            ofs << grid.getCell(0).type() << '\n';
+            ofs << grid[0].type() << '\n';
             ofs << grid.getLeafSize() << '\n' << ndims;
 
             std::array<unsigned int, ndims> dimsize = grid.getDimSizes();
             for (unsigned int i = 0; i < ndims; ++i)
                 ofs << '\n' << dimsize[i] << "\t";
 
-            for (unsigned int i = 0; i < grid.size(); ++i)
-                ofs << '\n' << grid.getCell(i).getValue();
+            for (typename L::index_t i = 0; i < grid.getNCells(); ++i)
+                ofs << '\n' << grid[grid.rowMajor2idx(i)].getValue();
 
             ofs.close();
         }
@@ -77,25 +79,61 @@ class GridWriter {
             getCell(ncells_-1).getValue()\n
 
             Use the parsegrid.m Matlab script to parse the data. */
-        template <class T, size_t ndims>
+        template <class T, size_t ndims, class L>
         static void saveVelocities
-        (const char * filename, nDGridMap<T, ndims> & grid) {
+        (const char * filename, nDGridMap<T, ndims, L> & grid) {
             std::ofstream ofs;
             ofs.open (filename,  std::ofstream::out | std::ofstream::trunc);
 
-            ofs << grid.getCell(0).type() << '\n';
+            ofs << grid[0].type() << '\n';
             ofs << grid.getLeafSize() << '\n' << ndims;
 
             std::array<unsigned int, ndims> dimsize = grid.getDimSizes();
             for (unsigned int i = 0; i < ndims; ++i)
                 ofs << '\n' << dimsize[i] << "\t";
 
-            for (unsigned int i = 0; i < grid.size(); ++i)
-                ofs << '\n' << grid.getCell(i).getVelocity();
+            for (typename L::index_t i = 0; i < grid.getNCells(); ++i)
+                ofs << '\n' << grid[grid.rowMajor2idx(i)].getVelocity();
 
             ofs.close();
         }
 
+        /** \brief Saves grid velocities and occupied cells in the binary format described in
+            gridfile.hpp, which can be loaded with MapLoader::loadMapFromBinary() or memory
+            mapped with FMCellMapped. */
+        template <class T, size_t ndims, class L>
+        static void saveGridBinary
+        (const char * filename, nDGridMap<T, ndims, L> & grid) {
+            std::ofstream ofs;
+            ofs.open (filename,  std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+
+            GridFileHeader header;
+            header.ndims = ndims;
+            header.ncells = grid.getNCells();
+            header.leafsize = grid.getLeafSize();
+            ofs.write(reinterpret_cast<const char *>(&header), sizeof(header)); // nobs written at the end.
+
+            std::array<unsigned int, ndims> dimsize = grid.getDimSizes();
+            for (unsigned int i = 0; i < ndims; ++i) {
+                const uint64_t d = dimsize[i];
+                ofs.write(reinterpret_cast<const char *>(&d), sizeof(d));
+            }
+
+            std::vector<uint64_t> obs;
+            for (typename L::index_t i = 0; i < grid.getNCells(); ++i) {
+                const double v = grid[grid.rowMajor2idx(i)].getVelocity();
+                ofs.write(reinterpret_cast<const char *>(&v), sizeof(v));
+                if (grid[grid.rowMajor2idx(i)].isOccupied())
+                    obs.push_back(i);
+            }
+            ofs.write(reinterpret_cast<const char *>(obs.data()), obs.size()*sizeof(uint64_t));
+
+            header.nobs = obs.size();
+            ofs.seekp(0);
+            ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            ofs.close();
+        }
+
         /** \brief Saves the 2D path in an ASCII file with the following format:
 
             leafsize_\n                          (float)
@@ -107,9 +145,9 @@ class GridWriter {
             ...
 
             Use the parsegrid.m and parsepath.m Matlab scripts to parse the data. */
-        template <class T, size_t ndims>
+        template <class T, size_t ndims, class L>
         static void savePath
-        (const char * filename, nDGridMap<T, ndims> & grid, std::vector< std::array<double,ndims> > & path) {
+        (const char * filename, nDGridMap<T, ndims, L> & grid, std::vector< std::array<double,ndims> > & path) {
             std::ofstream ofs;
             ofs.open (filename,  std::ofstream::out | std::ofstream::trunc);
 
@@ -139,9 +177,9 @@ class GridWriter {
             ...
 
             Use the parsegrid.m and parsepathvelocity.m Matlab scripts to parse the data. */
-        template <class T, size_t ndims>
+        template <class T, size_t ndims, class L>
         static void savePathVelocity
-        (const char * filename, nDGridMap<T, ndims> & grid, std::vector< std::array<double,ndims> > & path, std::vector <double> path_velocity) {
+        (const char * filename, nDGridMap<T, ndims, L> & grid, std::vector< std::array<double,ndims> > & path, std::vector <double> path_velocity) {
             std::ofstream ofs;
             ofs.open (filename,  std::ofstream::out | std::ofstream::trunc);
 
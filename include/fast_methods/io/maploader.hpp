@@ -20,9 +20,15 @@
 #ifndef MAPLOADER_H_
 #define MAPLOADER_H_
 
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
 #include <CImg.h>
 
 #include <fast_methods/ndgridmap/ndgridmap.hpp>
+#include <fast_methods/ndgridmap/fmcellmapped.h>
+#include <fast_methods/io/gridfile.hpp>
 
 
 using namespace cimg_library;
@@ -46,10 +52,10 @@ class MapLoader {
             @param filename file to be open
             @param grid 2D nDGridmap
             @param init_points stores the indices of all the values which are false. */
-        template<class T, size_t ndims>
+        template<class T, size_t ndims, class L>
         static void loadMapFromImg
-        (const char * filename, nDGridMap<T, ndims> & grid) {
-            std::vector<unsigned int> obs;
+        (const char * filename, nDGridMap<T, ndims, L> & grid) {
+            std::vector<typename L::index_t> obs;
             CImg<double> img(filename);
             std::array<unsigned int, ndims> dimsize;
             dimsize[0] = img.width();
@@ -59,7 +65,7 @@ class MapLoader {
             // Filling the grid flipping Y dim. We want bottom left to be the (0,0).
             cimg_forXY(img,x,y) {
                 double occupancy = img(x,y)/255;
-                unsigned int idx = img.width()*(img.height()-y-1)+x;
+                const typename L::index_t idx = grid.rowMajor2idx(img.width()*(img.height()-y-1)+x);
                 grid[idx].setOccupancy(occupancy);
                 if (grid[idx].isOccupied())
                     obs.push_back(idx);
@@ -91,11 +97,11 @@ class MapLoader {
             @param filename text file to be open
             @param grid 2D nDGridmap
             @param init_points stores the indices of all the values which are false. */
-        template<class T, size_t ndims>
+        template<class T, size_t ndims, class L>
         static int loadMapFromText
-        (const char * filename, nDGridMap<T, ndims> & grid) {
+        (const char * filename, nDGridMap<T, ndims, L> & grid) {
             std::ifstream file;
-            std::vector<unsigned int> obs;
+            std::vector<typename L::index_t> obs;
             file.open(filename);
 
             if (file.is_open())
@@ -123,13 +129,14 @@ class MapLoader {
                 grid.setLeafSize(leafsize);
 
                 double occupancy;
-                for (unsigned int i = 0; i < grid.size(); ++i)
+                for (typename L::index_t i = 0; i < grid.getNCells(); ++i)
                 {
                     file >> occupancy;
-                    grid[i].setOccupancy(occupancy);
+                    const typename L::index_t idx = grid.rowMajor2idx(i);
+                    grid[idx].setOccupancy(occupancy);
 
-                    if (grid[i].isOccupied())
-                        obs.push_back(i);
+                    if (grid[idx].isOccupied())
+                        obs.push_back(idx);
                 }
                 grid.setOccupiedCells(std::move(obs));
                 return 1;
@@ -140,6 +147,100 @@ class MapLoader {
                 return 0;
             }
         }
+
+        /** \brief Loads a grid saved with GridWriter::saveGridBinary() (format described in
+            gridfile.hpp). Velocities are copied into the grid, see the overload for
+            FMCellMapped to map them instead.
+
+            @param filename binary grid file to be open
+            @param grid nDGridmap with the same number of dimensions as the file. */
+        template<class T, size_t ndims, class L>
+        static int loadMapFromBinary
+        (const char * filename, nDGridMap<T, ndims, L> & grid) {
+            std::ifstream file;
+            std::array<unsigned int, ndims> dimsize;
+            GridFileHeader header;
+            if (!readBinaryHeader(filename, file, header, dimsize))
+                return 0;
+
+            grid.resize(dimsize);
+            grid.setLeafSize(header.leafsize);
+
+            double occupancy;
+            for (typename L::index_t i = 0; i < grid.getNCells(); ++i) {
+                file.read(reinterpret_cast<char *>(&occupancy), sizeof(occupancy));
+                grid[grid.rowMajor2idx(i)].setOccupancy(occupancy);
+            }
+
+            readBinaryObstacles(file, header, grid);
+            return 1;
+        }
+
+        /** \brief Opens a grid saved with GridWriter::saveGridBinary() as the velocities of
+            the grid, by memory mapping the file. Nothing but the header and the occupied
+            cells are read. */
+        template<size_t ndims, class I>
+        static int loadMapFromBinary
+        (const char * filename, nDGridMap<FMCellMapped, ndims, LinearLayout<ndims, I> > & grid) {
+            std::ifstream file;
+            std::array<unsigned int, ndims> dimsize;
+            GridFileHeader header;
+            if (!readBinaryHeader(filename, file, header, dimsize))
+                return 0;
+
+            grid.getStorage().setFile(filename, header.velocitiesOffset());
+            grid.resize(dimsize);
+            grid.setLeafSize(header.leafsize);
+
+            file.seekg(header.obstaclesOffset());
+            readBinaryObstacles(file, header, grid);
+            return 1;
+        }
+
+    private:
+        /** \brief Opens a binary grid file, reads and checks its header and reads the dimension sizes.
+            The file is left at the beginning of the velocities. */
+        template<size_t ndims>
+        static int readBinaryHeader
+        (const char * filename, std::ifstream & file, GridFileHeader & header, std::array<unsigned int, ndims> & dimsize) {
+            file.open(filename, std::ifstream::in | std::ifstream::binary);
+            if (!file.is_open()) {
+                console::error("File not found.");
+                return 0;
+            }
+
+            file.read(reinterpret_cast<char *>(&header), sizeof(header));
+            if (!file || !header.isValid()) {
+                console::error("Not a binary grid file (or unsupported version).");
+                return 0;
+            }
+
+            if (header.ndims != ndims) {
+                console::error("Number of dimensions specified does not match the loaded grid.");
+                exit(1);
+            }
+
+            for (unsigned int &d : dimsize) {
+                uint64_t d64;
+                file.read(reinterpret_cast<char *>(&d64), sizeof(d64));
+                d = d64;
+            }
+            return 1;
+        }
+
+        /** \brief Reads the occupied cells of a binary grid file, from the current position. */
+        template<class T, size_t ndims, class L>
+        static void readBinaryObstacles
+        (std::ifstream & file, const GridFileHeader & header, nDGridMap<T, ndims, L> & grid) {
+            std::vector<uint64_t> rowMajor(header.nobs);
+            file.read(reinterpret_cast<char *>(rowMajor.data()), rowMajor.size()*sizeof(uint64_t));
+
+            std::vector<typename L::index_t> obs;
+            obs.reserve(rowMajor.size());
+            for (uint64_t i : rowMajor)
+                obs.push_back(grid.rowMajor2idx(i));
+            grid.setOccupiedCells(std::move(obs));
+        }
 };
 
 #endif /* MAPLOADER_H_ */
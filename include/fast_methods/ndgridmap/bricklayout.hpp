@@ -0,0 +1,182 @@
+/*! \class BrickLayout
+    \brief Tiled layout of nDGridMap: the grid is split in bricks of 2^logB cells per
+    dimension (8x8x8 by default in 3D). Cells inside a brick are stored contiguously in
+    row-major order, and bricks are stored in row-major order as well.
+
+    With the linear layout, the neighbors of a cell in the last dimensions are a whole
+    row or slab away in memory, so on large 3D grids most of those accesses are cache
+    (and TLB) misses. Within a brick, neighbors in every dimension are at most
+    2^(logB*(ndims-1)) cells away (64 cells for 8x8x8 bricks).
+
+    Dimension sizes are rounded up to a multiple of the brick size. The extra slots are
+    set as occupied by nDGridMap::resize() and they are never expanded by solvers.
+
+    Use it as nDGridMap<FMCell, ndims, BrickLayout<ndims> >. Indices are not consecutive
+    in the real cells, always use coord2idx() and idx2coord() to address the grid.
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BRICKLAYOUT_HPP_
+#define BRICKLAYOUT_HPP_
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+template <size_t ndims, class I = unsigned int, unsigned int logB = 3> class BrickLayout {
+    /** \brief Cells per dimension of a brick. */
+    static constexpr unsigned int B = 1u << logB;
+
+    /** \brief Mask to obtain the coordinate within a brick. */
+    static constexpr unsigned int mask_ = B - 1;
+
+    /** \brief log2 of the number of cells of a brick. */
+    static constexpr unsigned int logBrick_ = logB*ndims;
+
+    public:
+        /** \brief Type of the indices (unsigned int by default, size_t for grids over 2^32 cells). */
+        typedef I index_t;
+
+        /** \brief True if the container has slots which are not cells of the grid. */
+        static constexpr bool padded = true;
+
+        /** \brief Computes the number of bricks in each dimension and their strides. */
+        void resize
+        (const std::array<unsigned int, ndims> & dimsize) {
+            dimsize_ = dimsize;
+            index_t nbricks = 1;
+            for (size_t i = 0; i < ndims; ++i) {
+                nb_[i] = (dimsize_[i] + mask_) >> logB;
+                bstride_[i] = nbricks << logBrick_;
+                nbricks *= nb_[i];
+            }
+            size_ = nbricks << logBrick_;
+        }
+
+        /** \brief Returns the number of slots required in the container (rounded up to full bricks). */
+        inline index_t size
+        () const {
+            return size_;
+        }
+
+        /** \brief Returns true if slot idx is out of the grid (in the last brick of a dimension). */
+        bool isPadding
+        (index_t idx) const {
+            std::array<unsigned int, ndims> coords;
+            idx2coord(idx, coords);
+            for (size_t i = 0; i < ndims; ++i)
+                if (coords[i] >= dimsize_[i])
+                    return true;
+            return false;
+        }
+
+        /** \brief Transforms from coordinates to index. */
+        inline index_t coord2idx
+        (const std::array<unsigned int, ndims> & coords) const {
+            index_t idx = 0;
+            for (size_t i = 0; i < ndims; ++i)
+                idx += (coords[i] >> logB)*bstride_[i] + ((coords[i] & mask_) << (logB*i));
+            return idx;
+        }
+
+        /** \brief Transforms from index to coordinates. */
+        inline void idx2coord
+        (index_t idx, std::array<unsigned int, ndims> & coords) const {
+            index_t brick = idx >> logBrick_;
+            for (size_t i = ndims; i-- > 0; ) {
+                const unsigned int bc = brick / (bstride_[i] >> logBrick_);
+                brick -= bc*(bstride_[i] >> logBrick_);
+                coords[i] = (bc << logB) + ((idx >> (logB*i)) & mask_);
+            }
+        }
+
+        /** \brief Returns the index of the n-th cell in row-major order. */
+        inline index_t rowMajor2idx
+        (index_t n) const {
+            std::array<unsigned int, ndims> coords;
+            for (size_t i = 0; i < ndims; ++i) {
+                coords[i] = n % dimsize_[i];
+                n /= dimsize_[i];
+            }
+            return coord2idx(coords);
+        }
+
+        /** \brief Returns the index of the cell next to idx in dimension dim, towards dir (-1 or 1).
+            No boundary checks are done. */
+        inline index_t step
+        (index_t idx, unsigned int dim, int dir) const {
+            const unsigned int local = (idx >> (logB*dim)) & mask_;
+            if (dir > 0)
+                return (local < mask_) ? idx + (1u << (logB*dim)) : idx + bstride_[dim] - (mask_ << (logB*dim));
+            else
+                return (local > 0) ? idx - (1u << (logB*dim)) : idx - bstride_[dim] + (mask_ << (logB*dim));
+        }
+
+        /** \brief Stores the valid neighbors of cell idx in dimension dim in neighs[n], neighs[n+1],
+            incrementing n accordingly. Only the neighbors in other bricks require a boundary check. */
+        template <size_t N>
+        inline void getNeighborsInDim
+        (index_t idx, std::array<index_t, N> & neighs, unsigned int & n, unsigned int dim) const {
+            const unsigned int local = (idx >> (logB*dim)) & mask_;
+            const unsigned int offset = 1u << (logB*dim);
+            if (local > 0)
+                neighs[n++] = idx - offset;
+            else if (brickCoord(idx, dim) > 0)
+                neighs[n++] = idx - bstride_[dim] + (mask_ << (logB*dim));
+
+            if (local < mask_)
+                neighs[n++] = idx + offset;
+            else if (brickCoord(idx, dim) < nb_[dim] - 1)
+                neighs[n++] = idx + bstride_[dim] - (mask_ << (logB*dim));
+        }
+
+        /** \brief Computes the indices of the 4-connectivity neighbors of cell idx. Returns
+            the number of neighbors found. */
+        inline unsigned int getNeighbors
+        (index_t idx, std::array<index_t, 2*ndims> & neighs) const {
+            unsigned int n = 0;
+            for (unsigned int i = 0; i < ndims; ++i)
+                getNeighborsInDim(idx, neighs, n, i);
+            return n;
+        }
+
+        /** \brief Returns the name of the layout. */
+        static std::string name
+        () {
+            return std::string("Brick");
+        }
+
+    private:
+        /** \brief Returns the coordinate of the brick containing idx in dimension dim. */
+        inline unsigned int brickCoord
+        (index_t idx, unsigned int dim) const {
+            return (idx / bstride_[dim]) % nb_[dim];
+        }
+
+        /** \brief Size of each dimension. */
+        std::array<unsigned int, ndims> dimsize_;
+
+        /** \brief Number of bricks in each dimension. */
+        std::array<unsigned int, ndims> nb_;
+
+        /** \brief Distance between the first cells of consecutive bricks in each dimension. */
+        std::array<index_t, ndims> bstride_;
+
+        /** \brief Number of slots. */
+        index_t size_;
+};
+
+#endif /* BRICKLAYOUT_HPP_*/
@@ -4,6 +4,11 @@
     A stand-alone, standard C++ class which represents each one of the cells
     of a gridmap and its typical members.
 
+    Member functions are not virtual: cells are always used through templates
+    (nDGridMap<T, ndims>, solvers and heaps), so the calls are statically dispatched
+    and can be inlined, and cells do not carry a vtable pointer. Derived cells
+    are used as the template parameter of the grid, never through a base pointer.
+
     IMPORTANT NOTE: no checks are done in the set functions.
     Copyright (C) 2014 Javier V. Gomez and Jose Pardeiro
     www.javiervgomez.com
@@ -36,25 +41,29 @@ class Cell {
     friend std::ostream& operator << (std::ostream & os, Cell & c);
 
     public:
+        /** \brief Type of the index stored. 32 bits keep the cell small, so grids with these cells
+            are limited to 2^32 cells (nDGridMap checks it at compile time). */
+        typedef unsigned int index_t;
+
         /** \brief Default constructor: sets value_ to -1 and occupancy_ to true (clear cell, not occupied). */
         Cell() : value_(-1), occupancy_(1) {}
 
         Cell(double v, double o = 1) : value_(v), occupancy_(o) {}
 
-        virtual inline void setValue(double v)            {value_ = v;}
-        virtual inline void setOccupancy(double o)        {occupancy_ = o;}
-        virtual std::string type()                        {return std::string("Cell - Basic cell");}
-        virtual inline void setIndex(int i)               {index_ = i;}
+        inline void setValue(double v)            {value_ = v;}
+        inline void setOccupancy(double o)        {occupancy_ = o;}
+        std::string type() const                  {return std::string("Cell - Basic cell");}
+        inline void setIndex(index_t i)           {index_ = i;}
 
         /** \brief Sets default values for the cell. Concretely, restarts value_ = -1 but
             occupancy_ is not modified. */
-        virtual void setDefault();
+        inline void setDefault()                  {value_ = -1;}
 
-        virtual inline double getValue() const             {return value_;}
-        virtual inline double getOccupancy() const         {return occupancy_;}
-        virtual inline unsigned int getIndex() const       {return index_;}
+        inline double getValue() const             {return value_;}
+        inline double getOccupancy() const         {return occupancy_;}
+        inline index_t getIndex() const            {return index_;}
 
-        virtual inline bool isOccupied() const {
+        inline bool isOccupied() const {
             if (occupancy_ < utils::COMP_MARGIN)
                 return true;
             return false;
@@ -68,7 +77,7 @@ class Cell {
         double occupancy_;
 
         /** \briefbIndex within the grid. Useful when used in heaps. */
-        unsigned int index_;
+        index_t index_;
 };
 
 #endif /* CELL_H_*/
@@ -0,0 +1,191 @@
+/*! \class FMCellFloat
+    \brief Fast Marching cell stored as a structure of arrays in single precision.
+
+    nDGridMap<FMCellFloat, ndims, L> stores the cells as FMCellSoA does (one array per
+    cell member), but arrival times, velocities and heuristic values are floats. A cell
+    takes 13 bytes instead of 25 and the solvers load half the bytes per neighbor, which
+    is enough for maps loaded from 8-bit images.
+
+    The interface is the same as FMCell (doubles), so that all the solvers run on it
+    without modifications: they compute in double precision and the values are rounded
+    when stored. As the stored times carry a relative error of about 6e-8, the solvers
+    compare them with the margin given by utils::isTimeBetterThan<float>() (value_t of
+    the grid), otherwise sweeping methods would never converge.
+
+    IMPORTANT NOTE: proxies are returned by value. Do not keep pointers or references
+    to the cells of the grid, use their indices instead.
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FMCELLFLOAT_H_
+#define FMCELLFLOAT_H_
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <limits>
+#include <vector>
+
+#include <fast_methods/ndgridmap/fmcell.h>
+#include <fast_methods/ndgridmap/ndgridmap.hpp>
+#include <fast_methods/utils/utils.h>
+
+class FMCellFloat;
+
+/** \brief Container of the FMCellFloat cells: one single precision array per cell member. */
+class FMCellFloatStorage {
+    friend class FMCellFloat;
+
+    public:
+        /** \brief Proxy type returned when accessing a cell. */
+        typedef FMCellFloat reference;
+
+        /** \brief Proxy type returned when accessing a cell of a const storage. */
+        typedef FMCellFloat const_reference;
+
+        /** \brief Resizes all the arrays, initializing the cells as FMCell() does. */
+        void resize
+        (size_t n) {
+            values_.assign(n, std::numeric_limits<float>::infinity());
+            velocities_.assign(n, 1);
+            hValues_.assign(n, 0);
+            states_.assign(n, FMState::OPEN);
+        }
+
+        /** \brief Restarts the arrival times, heuristic values and states of all the cells
+            (see FMCellFloat::setDefault()). */
+        void setDefault
+        () {
+            std::fill(values_.begin(), values_.end(), std::numeric_limits<float>::infinity());
+            std::fill(hValues_.begin(), hValues_.end(), 0);
+            std::fill(states_.begin(), states_.end(), FMState::OPEN);
+        }
+
+        /** \brief Deallocates all the arrays. */
+        void clear
+        () {
+            values_.clear();
+            velocities_.clear();
+            hValues_.clear();
+            states_.clear();
+        }
+
+        /** \brief Returns the number of cells stored. */
+        size_t size
+        () const {
+            return values_.size();
+        }
+
+        inline FMCellFloat operator[] (size_t idx);
+
+        /** \brief Constness is not propagated to the proxy, it is up to the caller
+            not to modify the cell. */
+        inline FMCellFloat operator[] (size_t idx) const;
+
+    private:
+        /** \brief Arrival times (value_ member of FMCell). */
+        std::vector<float> values_;
+
+        /** \brief Velocities (occupancy_ member of FMCell). */
+        std::vector<float> velocities_;
+
+        /** \brief Heuristic values. */
+        std::vector<float> hValues_;
+
+        /** \brief States of the cells. */
+        std::vector<FMState> states_;
+};
+
+class FMCellFloat {
+    friend std::ostream& operator << (std::ostream & os, const FMCellFloat & c);
+
+    public:
+        /** \brief Type of the index. The proxy is not stored, so 64 bits come for free and
+            these cells can be used in grids of any size. */
+        typedef size_t index_t;
+
+        FMCellFloat
+        (FMCellFloatStorage * s, index_t idx) : s_(s), idx_(idx) {}
+
+        inline void setValue(double v)                  {s_->values_[idx_] = float(v);}
+        inline void setOccupancy(double o)              {s_->velocities_[idx_] = float(o);}
+        inline void setVelocity(double v)               {s_->velocities_[idx_] = float(v);}
+        inline void setArrivalTime(double at)           {s_->values_[idx_] = float(at);}
+        inline void setHeuristicTime(double hv)         {s_->hValues_[idx_] = float(hv);}
+        inline void setState(FMState state)             {s_->states_[idx_] = state;}
+
+        /** \brief The index is given by the position in the storage, nothing to do. */
+        inline void setIndex(index_t)                   {}
+
+        /** \brief Sets default values for the cell. Concretely, restarts value_ = Inf, state_ = OPEN and
+            hValue_ = 0 but velocity is not modified. */
+        inline void setDefault() {
+            s_->values_[idx_] = std::numeric_limits<float>::infinity();
+            s_->hValues_[idx_] = 0;
+            s_->states_[idx_] = FMState::OPEN;
+        }
+
+        std::string type() const {return std::string("FMCellFloat - Fast Marching cell (single precision SoA storage)");}
+
+        inline double getValue() const                  {return s_->values_[idx_];}
+        inline double getOccupancy() const              {return s_->velocities_[idx_];}
+        inline index_t getIndex() const                 {return idx_;}
+        inline double getArrivalTime() const            {return s_->values_[idx_];}
+        inline double getHeuristicValue() const         {return s_->hValues_[idx_];}
+        inline double getTotalValue() const             {return double(s_->values_[idx_]) + s_->hValues_[idx_];}
+        inline double getVelocity() const               {return s_->velocities_[idx_];}
+        inline FMState getState() const                 {return s_->states_[idx_];}
+
+        inline bool isOccupied() const {
+            return s_->velocities_[idx_] < utils::COMP_MARGIN;
+        }
+
+    private:
+        /** \brief Storage the cell belongs to. */
+        FMCellFloatStorage * s_;
+
+        /** \brief Index within the grid. */
+        index_t idx_;
+};
+
+inline FMCellFloat FMCellFloatStorage::operator[]
+(size_t idx) {
+    return FMCellFloat(this, idx);
+}
+
+inline FMCellFloat FMCellFloatStorage::operator[]
+(size_t idx) const {
+    return FMCellFloat(const_cast<FMCellFloatStorage *>(this), idx);
+}
+
+/** \brief nDGridMap<FMCellFloat, ndims> stores its cells in a FMCellFloatStorage. */
+template <> struct nDGridStorage<FMCellFloat> {
+    typedef FMCellFloatStorage type;
+    typedef float value_t;
+
+    static constexpr bool stamped = false;
+
+    /** \brief Indices are given by the position in the arrays, nothing to do. */
+    static void setIndices
+    (type &) {}
+
+    static void setDefault
+    (type & cells) {
+        cells.setDefault();
+    }
+};
+
+#endif /* FMCELLFLOAT_H_*/
@@ -0,0 +1,319 @@
+/*! \class FMCellMapped
+    \brief Fast Marching cell stored in memory mappings (out-of-core grids).
+
+    nDGridMap<FMCellMapped, ndims> keeps every member of the cell in its own array, as
+    FMCellSoA, but the arrays are memory mappings instead of std::vector:
+    - Velocities are a private mapping of a binary grid file (see gridfile.hpp), opened
+      with MapLoader::loadMapFromBinary(). Pages are read on demand and shared through
+      the page cache by all the processes which map the same file. The file is never
+      modified: if a velocity is changed, only a private copy of its page is.
+    - Arrival times, heuristic values and states are anonymous (scratch) mappings, which
+      are not allocated until written. Arrival times are stored xor-ed with the bits of
+      infinity, so that the zero pages given by the system are default cells.
+
+    Therefore, opening a grid does not read it and nDGridMap::clean() only releases the
+    scratch pages. If the grid is resized without a file, velocities are also a scratch
+    mapping initialized to 1.
+
+    Only for LinearLayout: grid files are stored in row-major order.
+
+    FMCellMapped is a lightweight proxy (storage pointer and index) which provides the
+    same interface as FMCell, so that all solvers run on it without modifications.
+
+    IMPORTANT NOTE: proxies are returned by value. Do not keep pointers or references
+    to the cells of the grid, use their indices instead. Requires POSIX mmap().
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FMCELLMAPPED_H_
+#define FMCELLMAPPED_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fast_methods/console/console.h>
+#include <fast_methods/ndgridmap/fmcell.h>
+#include <fast_methods/ndgridmap/ndgridmap.hpp>
+#include <fast_methods/utils/utils.h>
+
+class FMCellMapped;
+
+/** \brief Container of the FMCellMapped cells: one memory mapping per cell member. */
+class FMCellMappedStorage {
+    friend class FMCellMapped;
+
+    public:
+        /** \brief Proxy type returned when accessing a cell. */
+        typedef FMCellMapped reference;
+
+        /** \brief Proxy type returned when accessing a cell of a const storage. */
+        typedef FMCellMapped const_reference;
+
+        FMCellMappedStorage() : size_(0), file_(nullptr), fileBytes_(0), offset_(0),
+            velocities_(nullptr), values_(nullptr), hValues_(nullptr), states_(nullptr) {}
+
+        ~FMCellMappedStorage() { clear(); }
+
+        FMCellMappedStorage(const FMCellMappedStorage &) = delete;
+        FMCellMappedStorage & operator=(const FMCellMappedStorage &) = delete;
+
+        /** \brief Sets the file the velocities will be mapped from in the next resize(),
+            starting at byte offset. */
+        void setFile
+        (const std::string & filename, uint64_t offset) {
+            filename_ = filename;
+            offset_ = offset;
+        }
+
+        /** \brief Maps n cells. Velocities are mapped from the file set, if any. */
+        void resize
+        (size_t n) {
+            clear();
+            size_ = n;
+            if (n == 0)
+                return;
+
+            if (!filename_.empty()) {
+                const int fd = open(filename_.c_str(), O_RDONLY);
+                struct stat st;
+                if (fd < 0 || fstat(fd, &st) != 0 || uint64_t(st.st_size) < offset_ + n*sizeof(double)) {
+                    console::error("Cannot map the grid file " + filename_);
+                    exit(1);
+                }
+                fileBytes_ = st.st_size;
+                file_ = static_cast<char *>(mmap(nullptr, fileBytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0));
+                close(fd); // The mapping keeps the file open.
+                if (file_ == MAP_FAILED) {
+                    file_ = nullptr;
+                    console::error("Cannot map the grid file " + filename_);
+                    exit(1);
+                }
+                velocities_ = reinterpret_cast<double *>(file_ + offset_);
+            }
+            else {
+                velocities_ = scratch<double>(n);
+                std::fill(velocities_, velocities_ + n, 1);
+            }
+            values_ = scratch<uint64_t>(n);
+            hValues_ = scratch<double>(n);
+            states_ = scratch<FMState>(n);
+        }
+
+        /** \brief Restarts arrival times, heuristic values and states of all the cells by
+            releasing their pages. Velocities are not modified. */
+        void setDefault
+        () {
+            if (size_ == 0)
+                return;
+            madvise(values_, size_*sizeof(uint64_t), MADV_DONTNEED);
+            madvise(hValues_, size_*sizeof(double), MADV_DONTNEED);
+            madvise(states_, size_*sizeof(FMState), MADV_DONTNEED);
+        }
+
+        /** \brief Unmaps all the arrays. The file set is kept. */
+        void clear
+        () {
+            if (file_)
+                munmap(file_, fileBytes_);
+            else if (velocities_)
+                munmap(velocities_, size_*sizeof(double));
+            if (values_) {
+                munmap(values_, size_*sizeof(uint64_t));
+                munmap(hValues_, size_*sizeof(double));
+                munmap(states_, size_*sizeof(FMState));
+            }
+            file_ = nullptr;
+            velocities_ = nullptr;
+            values_ = nullptr;
+            hValues_ = nullptr;
+            states_ = nullptr;
+            size_ = 0;
+        }
+
+        /** \brief Returns the number of cells stored. */
+        size_t size
+        () const {
+            return size_;
+        }
+
+        inline FMCellMapped operator[] (size_t idx);
+
+        /** \brief Constness is not propagated to the proxy, it is up to the caller
+            not to modify the cell. */
+        inline FMCellMapped operator[] (size_t idx) const;
+
+    private:
+        /** \brief Creates a zero-initialized anonymous mapping of n elements. */
+        template <class E>
+        static E * scratch
+        (size_t n) {
+            void * p = mmap(nullptr, n*sizeof(E), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (p == MAP_FAILED) {
+                console::error("Cannot allocate the memory mappings of the grid.");
+                exit(1);
+            }
+            return static_cast<E *>(p);
+        }
+
+        /** \brief Returns the bits of infinity. */
+        static inline uint64_t infBits
+        () {
+            const double inf = std::numeric_limits<double>::infinity();
+            uint64_t bits;
+            std::memcpy(&bits, &inf, sizeof(double));
+            return bits;
+        }
+
+        /** \brief Returns the bits of v xor-ed with those of infinity (0 for infinity). */
+        static inline uint64_t encode
+        (double v) {
+            uint64_t bits;
+            std::memcpy(&bits, &v, sizeof(double));
+            return bits ^ infBits();
+        }
+
+        /** \brief Inverse of encode(). */
+        static inline double decode
+        (uint64_t bits) {
+            bits ^= infBits();
+            double v;
+            std::memcpy(&v, &bits, sizeof(double));
+            return v;
+        }
+
+        /** \brief Number of cells. */
+        size_t size_;
+
+        /** \brief File to map the velocities from. */
+        std::string filename_;
+
+        /** \brief Mapping of the whole file, nullptr if velocities are a scratch mapping. */
+        char * file_;
+
+        /** \brief Size of the file mapping. */
+        uint64_t fileBytes_;
+
+        /** \brief Offset of the velocities in the file. */
+        uint64_t offset_;
+
+        /** \brief Velocities (occupancy_ member of FMCell). */
+        double * velocities_;
+
+        /** \brief Arrival times, encoded. */
+        uint64_t * values_;
+
+        /** \brief Heuristic values. */
+        double * hValues_;
+
+        /** \brief States of the cells. */
+        FMState * states_;
+};
+
+class FMCellMapped {
+    friend std::ostream& operator << (std::ostream & os, const FMCellMapped & c);
+
+    public:
+        /** \brief Type of the index. The proxy is not stored, so 64 bits come for free and
+            these cells can be used in grids of any size. */
+        typedef size_t index_t;
+
+        FMCellMapped
+        (FMCellMappedStorage * s, index_t idx) : s_(s), idx_(idx) {}
+
+        inline void setValue(double v)                  {s_->values_[idx_] = FMCellMappedStorage::encode(v);}
+        inline void setArrivalTime(double at)           {s_->values_[idx_] = FMCellMappedStorage::encode(at);}
+        inline void setHeuristicTime(double hv)         {s_->hValues_[idx_] = hv;}
+        inline void setState(FMState state)             {s_->states_[idx_] = state;}
+        inline void setOccupancy(double o)              {setVelocity(o);}
+
+        /** \brief Pages of the file are only copied if the velocity changes. */
+        inline void setVelocity(double v) {
+            if (s_->velocities_[idx_] != v)
+                s_->velocities_[idx_] = v;
+        }
+
+        /** \brief The index is given by the position in the storage, nothing to do. */
+        inline void setIndex(index_t)                   {}
+
+        /** \brief Sets default values for the cell. Concretely, restarts value_ = Inf, state_ = OPEN and
+            hValue_ = 0 but velocity is not modified. */
+        inline void setDefault() {
+            s_->values_[idx_] = 0;
+            s_->hValues_[idx_] = 0;
+            s_->states_[idx_] = FMState::OPEN;
+        }
+
+        std::string type() const {return std::string("FMCellMapped - Fast Marching cell (memory mapped)");}
+
+        inline double getValue() const                  {return FMCellMappedStorage::decode(s_->values_[idx_]);}
+        inline double getOccupancy() const              {return s_->velocities_[idx_];}
+        inline index_t getIndex() const                 {return idx_;}
+        inline double getArrivalTime() const            {return getValue();}
+        inline double getHeuristicValue() const         {return s_->hValues_[idx_];}
+        inline double getTotalValue() const             {return getValue() + s_->hValues_[idx_];}
+        inline double getVelocity() const               {return s_->velocities_[idx_];}
+        inline FMState getState() const                 {return s_->states_[idx_];}
+
+        inline bool isOccupied() const {
+            return s_->velocities_[idx_] < utils::COMP_MARGIN;
+        }
+
+    private:
+        /** \brief Storage the cell belongs to. */
+        FMCellMappedStorage * s_;
+
+        /** \brief Index within the grid. */
+        index_t idx_;
+};
+
+inline FMCellMapped FMCellMappedStorage::operator[]
+(size_t idx) {
+    return FMCellMapped(this, idx);
+}
+
+inline FMCellMapped FMCellMappedStorage::operator[]
+(size_t idx) const {
+    return FMCellMapped(const_cast<FMCellMappedStorage *>(this), idx);
+}
+
+/** \brief nDGridMap<FMCellMapped, ndims> stores its cells in a FMCellMappedStorage. */
+template <> struct nDGridStorage<FMCellMapped> {
+    typedef FMCellMappedStorage type;
+    typedef double value_t;
+
+    static constexpr bool stamped = false;
+
+    /** \brief Indices are given by the position in the storage, nothing to do. */
+    static void setIndices
+    (type &) {}
+
+    static void setDefault
+    (type & cells) {
+        cells.setDefault();
+    }
+};
+
+#endif /* FMCELLMAPPED_H_*/
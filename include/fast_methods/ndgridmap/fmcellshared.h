@@ -0,0 +1,253 @@
+/*! \class FMCellShared
+    \brief Fast Marching cell whose velocity is shared by all the copies of the grid.
+
+    nDGridMap<FMCellShared, ndims, L> stores its cells as FMCellSoA (one array per cell
+    member) but split in two layers:
+    - Velocities: a single array, shared (reference counted) by the grid and all its copies.
+    - State: arrival times, heuristic values and states, owned by every grid.
+
+    Copying the grid only copies the state, so that a map can be loaded once and used by
+    many solvers at the same time, each one with its own copy (see
+    Solver::setEnvironment(const grid_t &)): N queries cost N state arrays and a single
+    velocities array. The shared map is only read.
+
+    The state of the cells is epoch-stamped: a cell whose stamp is older than the epoch
+    of the grid has default values (as FMCell()) and it is restarted the first time it is
+    modified in the current epoch. Therefore, nDGridMap::clean() is O(1): it only
+    increases the epoch. This is specially useful for queries which visit a small part of
+    the grid (goal-directed FMM*, for instance).
+
+    Velocities are copy-on-write: setting a velocity on a grid whose velocities are shared
+    copies them first, so that the other grids are not modified. Therefore, load the map
+    before copying it.
+
+    FMCellShared is a lightweight proxy (storage pointer and index) which provides the
+    same interface as FMCell, so that all solvers run on it without modifications.
+
+    IMPORTANT NOTE: proxies are returned by value. Do not keep pointers or references
+    to the cells of the grid, use their indices instead.
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FMCELLSHARED_H_
+#define FMCELLSHARED_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fast_methods/ndgridmap/fmcell.h>
+#include <fast_methods/ndgridmap/ndgridmap.hpp>
+#include <fast_methods/utils/utils.h>
+
+class FMCellShared;
+
+/** \brief Container of the FMCellShared cells: shared velocities and own, epoch-stamped, state arrays. */
+class FMCellSharedStorage {
+    friend class FMCellShared;
+
+    public:
+        /** \brief Proxy type returned when accessing a cell. */
+        typedef FMCellShared reference;
+
+        /** \brief Proxy type returned when accessing a cell of a const storage. */
+        typedef FMCellShared const_reference;
+
+        FMCellSharedStorage() : epoch_(1) {}
+
+        /** \brief Resizes all the arrays, initializing the cells as FMCell() does. The
+            velocities are not shared anymore. */
+        void resize
+        (size_t n) {
+            velocities_ = std::make_shared<std::vector<double> >(n, 1);
+            values_.assign(n, std::numeric_limits<double>::infinity());
+            hValues_.assign(n, 0);
+            states_.assign(n, FMState::OPEN);
+            stamps_.assign(n, 0);
+            epoch_ = 1;
+        }
+
+        /** \brief Restarts the arrival times, heuristic values and states of all the cells
+            (see FMCellShared::setDefault()) by starting a new epoch. The stamps are only
+            cleared when the epoch counter wraps around. */
+        void setDefault
+        () {
+            if (++epoch_ == 0) {
+                std::fill(stamps_.begin(), stamps_.end(), 0);
+                epoch_ = 1;
+            }
+        }
+
+        /** \brief Deallocates the state arrays and releases the velocities. */
+        void clear
+        () {
+            velocities_.reset();
+            values_.clear();
+            hValues_.clear();
+            states_.clear();
+            stamps_.clear();
+        }
+
+        /** \brief Returns the number of cells stored. */
+        size_t size
+        () const {
+            return values_.size();
+        }
+
+        /** \brief Returns true if the velocities are shared with other grids. */
+        bool isShared
+        () const {
+            return velocities_ && velocities_.use_count() > 1;
+        }
+
+        inline FMCellShared operator[] (size_t idx);
+
+        /** \brief Constness is not propagated to the proxy, it is up to the caller
+            not to modify the cell. */
+        inline FMCellShared operator[] (size_t idx) const;
+
+    private:
+        /** \brief Returns true if the cell idx has been modified in the current epoch. */
+        inline bool isCurrent
+        (size_t idx) const {
+            return stamps_[idx] == epoch_;
+        }
+
+        /** \brief Restarts the state of the cell idx if it is from a previous epoch. To be
+            called before modifying it. */
+        inline void touch
+        (size_t idx) {
+            if (!isCurrent(idx)) {
+                values_[idx] = std::numeric_limits<double>::infinity();
+                hValues_[idx] = 0;
+                states_[idx] = FMState::OPEN;
+                stamps_[idx] = epoch_;
+            }
+        }
+
+        /** \brief Returns the velocities to be modified, copying them if they are shared. */
+        std::vector<double> & ownVelocities
+        () {
+            if (isShared())
+                velocities_ = std::make_shared<std::vector<double> >(*velocities_);
+            return *velocities_;
+        }
+
+        /** \brief Velocities (occupancy_ member of FMCell), shared by the copies of the storage. */
+        std::shared_ptr<std::vector<double> > velocities_;
+
+        /** \brief Arrival times (value_ member of FMCell). */
+        std::vector<double> values_;
+
+        /** \brief Heuristic values. */
+        std::vector<double> hValues_;
+
+        /** \brief States of the cells. */
+        std::vector<FMState> states_;
+
+        /** \brief Epoch in which each cell was modified for the last time. */
+        std::vector<uint32_t> stamps_;
+
+        /** \brief Current epoch, never 0. */
+        uint32_t epoch_;
+};
+
+class FMCellShared {
+    friend std::ostream& operator << (std::ostream & os, const FMCellShared & c);
+
+    public:
+        /** \brief Type of the index. The proxy is not stored, so 64 bits come for free and
+            these cells can be used in grids of any size. */
+        typedef size_t index_t;
+
+        FMCellShared
+        (FMCellSharedStorage * s, index_t idx) : s_(s), idx_(idx) {}
+
+        inline void setValue(double v)                  {s_->touch(idx_); s_->values_[idx_] = v;}
+        inline void setOccupancy(double o)              {setVelocity(o);}
+        inline void setArrivalTime(double at)           {s_->touch(idx_); s_->values_[idx_] = at;}
+        inline void setHeuristicTime(double hv)         {s_->touch(idx_); s_->hValues_[idx_] = hv;}
+        inline void setState(FMState state)             {s_->touch(idx_); s_->states_[idx_] = state;}
+
+        /** \brief Velocities shared with other grids are copied before being modified. */
+        inline void setVelocity(double v)               {s_->ownVelocities()[idx_] = v;}
+
+        /** \brief The index is given by the position in the storage, nothing to do. */
+        inline void setIndex(index_t)                   {}
+
+        /** \brief Sets default values for the cell. Concretely, restarts value_ = Inf, state_ = OPEN and
+            hValue_ = 0 but velocity is not modified. */
+        inline void setDefault() {
+            s_->stamps_[idx_] = 0;
+        }
+
+        std::string type() const {return std::string("FMCellShared - Fast Marching cell (shared velocities)");}
+
+        inline double getValue() const                  {return s_->isCurrent(idx_) ? s_->values_[idx_] : std::numeric_limits<double>::infinity();}
+        inline double getOccupancy() const              {return (*s_->velocities_)[idx_];}
+        inline index_t getIndex() const                 {return idx_;}
+        inline double getArrivalTime() const            {return getValue();}
+        inline double getHeuristicValue() const         {return s_->isCurrent(idx_) ? s_->hValues_[idx_] : 0;}
+        inline double getTotalValue() const             {return getValue() + getHeuristicValue();}
+        inline double getVelocity() const               {return (*s_->velocities_)[idx_];}
+        inline FMState getState() const                 {return s_->isCurrent(idx_) ? s_->states_[idx_] : FMState::OPEN;}
+
+        inline bool isOccupied() const {
+            return (*s_->velocities_)[idx_] < utils::COMP_MARGIN;
+        }
+
+    private:
+        /** \brief Storage the cell belongs to. */
+        FMCellSharedStorage * s_;
+
+        /** \brief Index within the grid. */
+        index_t idx_;
+};
+
+inline FMCellShared FMCellSharedStorage::operator[]
+(size_t idx) {
+    return FMCellShared(this, idx);
+}
+
+inline FMCellShared FMCellSharedStorage::operator[]
+(size_t idx) const {
+    return FMCellShared(const_cast<FMCellSharedStorage *>(this), idx);
+}
+
+/** \brief nDGridMap<FMCellShared, ndims> stores its cells in a FMCellSharedStorage. */
+template <> struct nDGridStorage<FMCellShared> {
+    typedef FMCellSharedStorage type;
+    typedef double value_t;
+
+    /** \brief Cells are epoch-stamped: setDefault() is O(1). */
+    static constexpr bool stamped = true;
+
+    /** \brief Indices are given by the position in the arrays, nothing to do. */
+    static void setIndices
+    (type &) {}
+
+    /** \brief Starts a new epoch. */
+    static void setDefault
+    (type & cells) {
+        cells.setDefault();
+    }
+};
+
+#endif /* FMCELLSHARED_H_*/
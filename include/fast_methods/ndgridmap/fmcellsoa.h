@@ -0,0 +1,189 @@
+/*! \class FMCellSoA
+    \brief Fast Marching cell stored as a structure of arrays (SoA).
+
+    nDGridMap<FMCellSoA, ndims> does not store FMCell objects. Instead, every
+    member of the cell (arrival time, velocity, state and heuristic value) is
+    kept in its own contiguous array in FMCellSoAStorage. FMCellSoA is a
+    lightweight proxy (storage pointer and index) which provides the same
+    interface as FMCell, so that all solvers run on it without modifications.
+
+    This reduces the memory traffic of the solvers: reading the arrival time
+    of a neighbor only loads 8 bytes instead of a whole FMCell.
+
+    IMPORTANT NOTE: proxies are returned by value. Do not keep pointers or references
+    to the cells of the grid, use their indices instead.
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FMCELLSOA_H_
+#define FMCELLSOA_H_
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <limits>
+#include <vector>
+
+#include <fast_methods/ndgridmap/fmcell.h>
+#include <fast_methods/ndgridmap/ndgridmap.hpp>
+#include <fast_methods/utils/utils.h>
+
+class FMCellSoA;
+
+/** \brief Container of the FMCellSoA cells: one array per cell member. */
+class FMCellSoAStorage {
+    friend class FMCellSoA;
+
+    public:
+        /** \brief Proxy type returned when accessing a cell. */
+        typedef FMCellSoA reference;
+
+        /** \brief Proxy type returned when accessing a cell of a const storage. */
+        typedef FMCellSoA const_reference;
+
+        /** \brief Resizes all the arrays, initializing the cells as FMCell() does. */
+        void resize
+        (size_t n) {
+            values_.assign(n, std::numeric_limits<double>::infinity());
+            velocities_.assign(n, 1);
+            hValues_.assign(n, 0);
+            states_.assign(n, FMState::OPEN);
+        }
+
+        /** \brief Restarts the arrival times, heuristic values and states of all the cells
+            (see FMCellSoA::setDefault()). */
+        void setDefault
+        () {
+            std::fill(values_.begin(), values_.end(), std::numeric_limits<double>::infinity());
+            std::fill(hValues_.begin(), hValues_.end(), 0);
+            std::fill(states_.begin(), states_.end(), FMState::OPEN);
+        }
+
+        /** \brief Deallocates all the arrays. */
+        void clear
+        () {
+            values_.clear();
+            velocities_.clear();
+            hValues_.clear();
+            states_.clear();
+        }
+
+        /** \brief Returns the number of cells stored. */
+        size_t size
+        () const {
+            return values_.size();
+        }
+
+        inline FMCellSoA operator[] (size_t idx);
+
+        /** \brief Constness is not propagated to the proxy, it is up to the caller
+            not to modify the cell. */
+        inline FMCellSoA operator[] (size_t idx) const;
+
+    private:
+        /** \brief Arrival times (value_ member of FMCell). */
+        std::vector<double> values_;
+
+        /** \brief Velocities (occupancy_ member of FMCell). */
+        std::vector<double> velocities_;
+
+        /** \brief Heuristic values. */
+        std::vector<double> hValues_;
+
+        /** \brief States of the cells. */
+        std::vector<FMState> states_;
+};
+
+class FMCellSoA {
+    friend std::ostream& operator << (std::ostream & os, const FMCellSoA & c);
+
+    public:
+        /** \brief Type of the index. The proxy is not stored, so 64 bits come for free and
+            these cells can be used in grids of any size. */
+        typedef size_t index_t;
+
+        FMCellSoA
+        (FMCellSoAStorage * s, index_t idx) : s_(s), idx_(idx) {}
+
+        inline void setValue(double v)                  {s_->values_[idx_] = v;}
+        inline void setOccupancy(double o)              {s_->velocities_[idx_] = o;}
+        inline void setVelocity(double v)               {s_->velocities_[idx_] = v;}
+        inline void setArrivalTime(double at)           {s_->values_[idx_] = at;}
+        inline void setHeuristicTime(double hv)         {s_->hValues_[idx_] = hv;}
+        inline void setState(FMState state)             {s_->states_[idx_] = state;}
+
+        /** \brief The index is given by the position in the storage, nothing to do. */
+        inline void setIndex(index_t)                   {}
+
+        /** \brief Sets default values for the cell. Concretely, restarts value_ = Inf, state_ = OPEN and
+            hValue_ = 0 but velocity is not modified. */
+        inline void setDefault() {
+            s_->values_[idx_] = std::numeric_limits<double>::infinity();
+            s_->hValues_[idx_] = 0;
+            s_->states_[idx_] = FMState::OPEN;
+        }
+
+        std::string type() const {return std::string("FMCellSoA - Fast Marching cell (SoA storage)");}
+
+        inline double getValue() const                  {return s_->values_[idx_];}
+        inline double getOccupancy() const              {return s_->velocities_[idx_];}
+        inline index_t getIndex() const                 {return idx_;}
+        inline double getArrivalTime() const            {return s_->values_[idx_];}
+        inline double getHeuristicValue() const         {return s_->hValues_[idx_];}
+        inline double getTotalValue() const             {return s_->values_[idx_] + s_->hValues_[idx_];}
+        inline double getVelocity() const               {return s_->velocities_[idx_];}
+        inline FMState getState() const                 {return s_->states_[idx_];}
+
+        inline bool isOccupied() const {
+            return s_->velocities_[idx_] < utils::COMP_MARGIN;
+        }
+
+    private:
+        /** \brief Storage the cell belongs to. */
+        FMCellSoAStorage * s_;
+
+        /** \brief Index within the grid. */
+        index_t idx_;
+};
+
+inline FMCellSoA FMCellSoAStorage::operator[]
+(size_t idx) {
+    return FMCellSoA(this, idx);
+}
+
+inline FMCellSoA FMCellSoAStorage::operator[]
+(size_t idx) const {
+    return FMCellSoA(const_cast<FMCellSoAStorage *>(this), idx);
+}
+
+/** \brief nDGridMap<FMCellSoA, ndims> stores its cells in a FMCellSoAStorage. */
+template <> struct nDGridStorage<FMCellSoA> {
+    typedef FMCellSoAStorage type;
+    typedef double value_t;
+
+    static constexpr bool stamped = false;
+
+    /** \brief Indices are given by the position in the arrays, nothing to do. */
+    static void setIndices
+    (type &) {}
+
+    static void setDefault
+    (type & cells) {
+        cells.setDefault();
+    }
+};
+
+#endif /* FMCELLSOA_H_*/
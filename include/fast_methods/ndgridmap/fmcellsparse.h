@@ -0,0 +1,335 @@
+/*! \class FMCellSparse
+    \brief Fast Marching cell stored in a sparse, tree-structured storage (VDB-like).
+
+    nDGridMap<FMCellSparse, ndims, L> does not allocate all the cells of the grid.
+    FMCellSparseStorage is a 3-level tree over the indices of the grid:
+    - Leaves: blocks of 512 consecutive indices, storing the members of their cells
+      as in FMCellSoA (arrival time, velocity, heuristic value and state).
+    - Nodes: 4096 leaves each. A leaf which has not been allocated is a tile: all its
+      cells have default values (as in FMCell()) and the velocity of the tile.
+    - Root: array of nodes. A node which has not been allocated has all its cells with
+      default values and the background velocity.
+
+    Leaves are allocated the first time one of their cells is modified. Setting the
+    velocity of a cell to the value of its tile does not allocate anything, so that
+    loading a mostly empty map only allocates the blocks with obstacles or different
+    velocities. nDGridMap::clean() restarts the allocated leaves and turns back into
+    tiles those with the same velocity in all their cells.
+
+    With BrickLayout<3, size_t> (8x8x8 bricks, 512 cells) leaves are cubic blocks of
+    the grid, so that the cells visited by a wave are packed in few leaves. It works
+    with any layout, for instance with LinearLayout leaves are segments of a row.
+
+    FMCellSparse is a lightweight proxy (storage pointer, index and leaf) which provides
+    the same interface as FMCell, so that all solvers run on it without modifications.
+
+    IMPORTANT NOTE: proxies are returned by value. Do not keep pointers or references
+    to the cells of the grid, use their indices instead. Proxies are invalidated by
+    nDGridMap::clean().
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FMCELLSPARSE_H_
+#define FMCELLSPARSE_H_
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fast_methods/ndgridmap/fmcell.h>
+#include <fast_methods/ndgridmap/ndgridmap.hpp>
+#include <fast_methods/utils/utils.h>
+
+class FMCellSparse;
+
+/** \brief Container of the FMCellSparse cells: tree of blocks allocated on demand. */
+class FMCellSparseStorage {
+    friend class FMCellSparse;
+
+    /** \brief log2 of the cells of a leaf. */
+    static constexpr unsigned int logLeaf_ = 9;
+
+    /** \brief log2 of the leaves of a node. */
+    static constexpr unsigned int logNode_ = 12;
+
+    /** \brief Cells of a leaf. */
+    static constexpr size_t leafCells_ = size_t(1) << logLeaf_;
+
+    /** \brief Leaves of a node. */
+    static constexpr size_t nodeLeaves_ = size_t(1) << logNode_;
+
+    /** \brief Block of cells, stored as a structure of arrays. */
+    struct Leaf {
+        /** \brief Initializes all the cells with default values and velocity v. */
+        Leaf
+        (double v) {
+            velocities_.fill(v);
+            setDefault();
+        }
+
+        /** \brief Restarts arrival times, heuristic values and states (see FMCell::setDefault()). */
+        void setDefault
+        () {
+            values_.fill(std::numeric_limits<double>::infinity());
+            hValues_.fill(0);
+            states_.fill(FMState::OPEN);
+        }
+
+        /** \brief Returns true if all the cells have velocity v (and default values). */
+        bool isTile
+        (double v) const {
+            for (double vel : velocities_)
+                if (vel != v)
+                    return false;
+            return true;
+        }
+
+        std::array<double, leafCells_>  values_;
+        std::array<double, leafCells_>  velocities_;
+        std::array<double, leafCells_>  hValues_;
+        std::array<FMState, leafCells_> states_;
+    };
+
+    /** \brief Internal node of the tree: children leaves or, if not allocated, their tile velocity. */
+    struct Node {
+        /** \brief Initializes all the children as tiles with velocity v. */
+        Node
+        (double v) {
+            tiles_.fill(v);
+        }
+
+        std::array<std::unique_ptr<Leaf>, nodeLeaves_>  leaves_;
+        std::array<double, nodeLeaves_>                 tiles_;
+    };
+
+    public:
+        /** \brief Proxy type returned when accessing a cell. */
+        typedef FMCellSparse reference;
+
+        /** \brief Proxy type returned when accessing a cell of a const storage. */
+        typedef FMCellSparse const_reference;
+
+        FMCellSparseStorage() : size_(0), background_(1) {}
+
+        /** \brief Resizes the index space. No cells are allocated: all of them have
+            default values (as FMCell()). */
+        void resize
+        (size_t n) {
+            root_.clear();
+            size_ = n;
+            root_.resize((n + (leafCells_ << logNode_) - 1) >> (logLeaf_ + logNode_));
+        }
+
+        /** \brief Restarts all the cells (see FMCellSparse::setDefault()) and deallocates the
+            leaves whose cells have all the same velocity, which become tiles. */
+        void setDefault
+        () {
+            for (std::unique_ptr<Node> & node : root_) {
+                if (!node)
+                    continue;
+                bool empty = true;
+                for (size_t i = 0; i < nodeLeaves_; ++i) {
+                    std::unique_ptr<Leaf> & leaf = node->leaves_[i];
+                    if (leaf) {
+                        if (leaf->isTile(leaf->velocities_[0])) {
+                            node->tiles_[i] = leaf->velocities_[0];
+                            leaf.reset();
+                        }
+                        else
+                            leaf->setDefault();
+                    }
+                    empty = empty && !leaf && node->tiles_[i] == background_;
+                }
+                if (empty)
+                    node.reset();
+            }
+        }
+
+        /** \brief Deallocates all the cells. */
+        void clear
+        () {
+            root_.clear();
+            size_ = 0;
+        }
+
+        /** \brief Returns the number of cells, allocated or not. */
+        size_t size
+        () const {
+            return size_;
+        }
+
+        inline FMCellSparse operator[] (size_t idx);
+
+        /** \brief Constness is not propagated to the proxy, it is up to the caller
+            not to modify the cell. */
+        inline FMCellSparse operator[] (size_t idx) const;
+
+    private:
+        /** \brief Returns the leaf containing idx, nullptr if it is a tile. */
+        inline Leaf * find
+        (size_t idx) const {
+            const Node * node = root_[idx >> (logLeaf_ + logNode_)].get();
+            return node ? node->leaves_[(idx >> logLeaf_) & (nodeLeaves_ - 1)].get() : nullptr;
+        }
+
+        /** \brief Returns the velocity of the tile containing idx. */
+        inline double tile
+        (size_t idx) const {
+            const Node * node = root_[idx >> (logLeaf_ + logNode_)].get();
+            return node ? node->tiles_[(idx >> logLeaf_) & (nodeLeaves_ - 1)] : background_;
+        }
+
+        /** \brief Returns the leaf containing idx, allocating it (and its node) from its tile if required. */
+        Leaf * touch
+        (size_t idx) {
+            std::unique_ptr<Node> & node = root_[idx >> (logLeaf_ + logNode_)];
+            if (!node)
+                node.reset(new Node(background_));
+            const size_t l = (idx >> logLeaf_) & (nodeLeaves_ - 1);
+            if (!node->leaves_[l])
+                node->leaves_[l].reset(new Leaf(node->tiles_[l]));
+            return node->leaves_[l].get();
+        }
+
+        /** \brief Nodes of the tree. */
+        std::vector<std::unique_ptr<Node> > root_;
+
+        /** \brief Number of cells. */
+        size_t size_;
+
+        /** \brief Velocity of the cells in nodes not allocated. */
+        double background_;
+};
+
+class FMCellSparse {
+    friend std::ostream& operator << (std::ostream & os, const FMCellSparse & c);
+
+    /** \brief Shorthand for the leaves of the storage. */
+    typedef FMCellSparseStorage::Leaf Leaf;
+
+    public:
+        /** \brief Type of the index. The proxy is not stored, so 64 bits come for free and
+            these cells can be used in grids of any size. */
+        typedef size_t index_t;
+
+        FMCellSparse
+        (FMCellSparseStorage * s, index_t idx) : s_(s), idx_(idx),
+            off_(idx & (FMCellSparseStorage::leafCells_ - 1)), leaf_(s->find(idx)) {}
+
+        inline void setValue(double v)                  {touch()->values_[off_] = v;}
+        inline void setArrivalTime(double at)           {touch()->values_[off_] = at;}
+        inline void setHeuristicTime(double hv)         {touch()->hValues_[off_] = hv;}
+        inline void setState(FMState state)             {touch()->states_[off_] = state;}
+        inline void setOccupancy(double o)              {setVelocity(o);}
+
+        /** \brief Setting the velocity of the tile does not allocate the leaf. */
+        inline void setVelocity(double v) {
+            if (leaf() || s_->tile(idx_) != v)
+                touch()->velocities_[off_] = v;
+        }
+
+        /** \brief The index is given by the position in the storage, nothing to do. */
+        inline void setIndex(index_t)                   {}
+
+        /** \brief Sets default values for the cell. Concretely, restarts value_ = Inf, state_ = OPEN and
+            hValue_ = 0 but velocity is not modified. Tiles have already default values. */
+        inline void setDefault() {
+            if (leaf()) {
+                leaf_->values_[off_] = std::numeric_limits<double>::infinity();
+                leaf_->hValues_[off_] = 0;
+                leaf_->states_[off_] = FMState::OPEN;
+            }
+        }
+
+        std::string type() const {return std::string("FMCellSparse - Fast Marching cell (sparse storage)");}
+
+        inline double getValue() const                  {return leaf() ? leaf_->values_[off_] : std::numeric_limits<double>::infinity();}
+        inline double getOccupancy() const              {return getVelocity();}
+        inline index_t getIndex() const                 {return idx_;}
+        inline double getArrivalTime() const            {return getValue();}
+        inline double getHeuristicValue() const         {return leaf() ? leaf_->hValues_[off_] : 0;}
+        inline double getTotalValue() const             {return getValue() + getHeuristicValue();}
+        inline double getVelocity() const               {return leaf() ? leaf_->velocities_[off_] : s_->tile(idx_);}
+        inline FMState getState() const                 {return leaf() ? leaf_->states_[off_] : FMState::OPEN;}
+
+        inline bool isOccupied() const {
+            return getVelocity() < utils::COMP_MARGIN;
+        }
+
+    private:
+        /** \brief Returns the leaf of the cell, nullptr if it is a tile. Looked up again while it
+            is a tile, in case another proxy of the same leaf allocated it. */
+        inline Leaf * leaf
+        () const {
+            if (!leaf_)
+                leaf_ = s_->find(idx_);
+            return leaf_;
+        }
+
+        /** \brief Returns the leaf of the cell, allocating it if required. */
+        inline Leaf * touch
+        () {
+            if (!leaf())
+                leaf_ = s_->touch(idx_);
+            return leaf_;
+        }
+
+        /** \brief Storage the cell belongs to. */
+        FMCellSparseStorage * s_;
+
+        /** \brief Index within the grid. */
+        index_t idx_;
+
+        /** \brief Position within the leaf. */
+        index_t off_;
+
+        /** \brief Leaf containing the cell, nullptr if not allocated (yet). */
+        mutable Leaf * leaf_;
+};
+
+inline FMCellSparse FMCellSparseStorage::operator[]
+(size_t idx) {
+    return FMCellSparse(this, idx);
+}
+
+inline FMCellSparse FMCellSparseStorage::operator[]
+(size_t idx) const {
+    return FMCellSparse(const_cast<FMCellSparseStorage *>(this), idx);
+}
+
+/** \brief nDGridMap<FMCellSparse, ndims, L> stores its cells in a FMCellSparseStorage. */
+template <> struct nDGridStorage<FMCellSparse> {
+    typedef FMCellSparseStorage type;
+    typedef double value_t;
+
+    static constexpr bool stamped = false;
+
+    /** \brief Indices are given by the position in the storage, nothing to do. */
+    static void setIndices
+    (type &) {}
+
+    /** \brief Only visits the allocated leaves. */
+    static void setDefault
+    (type & cells) {
+        cells.setDefault();
+    }
+};
+
+#endif /* FMCELLSPARSE_H_*/
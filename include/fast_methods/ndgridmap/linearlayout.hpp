@@ -0,0 +1,150 @@
+/*! \class LinearLayout
+    \brief Default memory layout of nDGridMap: cells are stored in a flat array in
+    row-major order (first dimension changes fastest), without padding.
+
+    A layout maps the coordinates of the cells to the indices of the container and
+    computes the neighbors of a cell. Every layout (LinearLayout, PaddedLayout...) has to
+    provide the same interface, since nDGridMap calls it statically (template parameter).
+
+    Neighbors are checked to be within the same n-dimensional slice (row, plane, cube, etc)
+    by integer divisions, see [nDGridMaps](http://javiervgomez.com/pages/n-dimensional-gridmaps-formulation-and-implementation.html)
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LINEARLAYOUT_HPP_
+#define LINEARLAYOUT_HPP_
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+template <size_t ndims, class I = unsigned int> class LinearLayout {
+    public:
+        /** \brief Type of the indices (unsigned int by default, size_t for grids over 2^32 cells). */
+        typedef I index_t;
+
+        /** \brief True if the container has slots which are not cells of the grid. */
+        static constexpr bool padded = false;
+
+        /** \brief Computes the auxiliar arrays for the given dimension sizes. */
+        void resize
+        (const std::array<unsigned int, ndims> & dimsize) {
+            dimsize_ = dimsize;
+            size_ = 1;
+            for (size_t i = 0; i < ndims; ++i) {
+                size_ *= dimsize_[i];
+                d_[i] = size_;
+            }
+        }
+
+        /** \brief Returns the number of slots required in the container. */
+        inline index_t size
+        () const {
+            return size_;
+        }
+
+        /** \brief Returns true if slot idx is not a cell of the grid. Never for this layout. */
+        inline bool isPadding
+        (index_t) const {
+            return false;
+        }
+
+        /** \brief Transforms from coordinates to index. */
+        inline index_t coord2idx
+        (const std::array<unsigned int, ndims> & coords) const {
+            index_t idx = coords[0];
+            for(size_t i = 1; i < ndims; ++i)
+                idx += coords[i]*d_[i-1];
+            return idx;
+        }
+
+        /** \brief Transforms from index to coordinates. */
+        inline void idx2coord
+        (index_t idx, std::array<unsigned int, ndims> & coords) const {
+            coords[ndims-1] = idx/d_[ndims-2]; // First step done apart.
+            index_t aux = idx - coords[ndims-1]*d_[ndims-2];
+            for (size_t i = ndims - 2; i > 0; --i) {
+                coords[i] = aux/d_[i-1];
+                aux -= coords[i]*d_[i-1];
+            }
+            coords[0] = aux; //Last step done apart.
+        }
+
+        /** \brief Returns the index of the n-th cell in row-major order. */
+        inline index_t rowMajor2idx
+        (index_t n) const {
+            return n;
+        }
+
+        /** \brief Returns the index of the cell next to idx in dimension dim, towards dir (-1 or 1).
+            No boundary checks are done. */
+        inline index_t step
+        (index_t idx, unsigned int dim, int dir) const {
+            return (dim == 0) ? idx + dir : idx + dir*d_[dim-1];
+        }
+
+        /** \brief Stores the valid neighbors of cell idx in dimension dim in neighs[n], neighs[n+1],
+            incrementing n accordingly. */
+        template <size_t N>
+        inline void getNeighborsInDim
+        (index_t idx, std::array<index_t, N> & neighs, unsigned int & n, unsigned int dim) const {
+            index_t c1,c2; // Candidate neighbors in dimension.
+            if (dim == 0) {
+                c1 = idx-1;
+                c2 = idx+1;
+            }
+            else {
+                c1 = idx-d_[dim-1];
+                c2 = idx+d_[dim-1];
+            }
+            // Checking neighbor 1: is in the same n-dimensional slice (row, plane, cube, etc)?
+            // If idx is in the first slice, c1 underflows and it is in another slice.
+            if (c1/d_[dim] == idx/d_[dim])
+                neighs[n++] = c1;
+            // Checking neighbor 2. Full check, not necessary: if >ncells_ then is in another slice.
+            if (c2/d_[dim] == idx/d_[dim])
+                neighs[n++] = c2;
+        }
+
+        /** \brief Computes the indices of the 4-connectivity neighbors of cell idx. Returns
+            the number of neighbors found. */
+        inline unsigned int getNeighbors
+        (index_t idx, std::array<index_t, 2*ndims> & neighs) const {
+            unsigned int n = 0;
+            for (unsigned int i = 0; i < ndims; ++i)
+                getNeighborsInDim(idx, neighs, n, i);
+            return n;
+        }
+
+        /** \brief Returns the name of the layout. */
+        static std::string name
+        () {
+            return std::string("Linear");
+        }
+
+    private:
+        /** \brief Size of each dimension. */
+        std::array<unsigned int, ndims> dimsize_;
+
+        /** \brief Stores parcial multiplications of dimensions sizes. d_[0] = dimsize_[0];
+            d_[1] = dimsize_[0]*dimsize_[1]; etc. */
+        std::array<index_t, ndims> d_;
+
+        /** \brief Number of slots. */
+        index_t size_;
+};
+
+#endif /* LINEARLAYOUT_HPP_*/
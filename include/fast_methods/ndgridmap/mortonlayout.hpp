@@ -0,0 +1,234 @@
+/*! \class MortonLayout
+    \brief Z-order (Morton) layout of nDGridMap: the index of a cell is obtained by
+    interleaving the bits of its coordinates, so that cells close in space are close in
+    memory in every dimension. The narrow band of FMM and UFMM grows as a roughly isotropic
+    front, which stays cache-local with this layout.
+
+    coord2idx() and idx2coord() use the BMI2 pdep/pext instructions when compiled with
+    them enabled (-mbmi2 or -march=native on recent x86 CPUs) and a portable bit loop otherwise.
+    Neighbors are computed directly in Morton space using dilated integer arithmetic
+    (no interleaving required): the coordinate bits of dimension dim are selected with
+    masks_[dim] and incremented or decremented, filling or clearing the bits of the other
+    dimensions so that the carry propagates.
+
+    Each dimension takes the bits it needs (the smallest power of two not smaller than its
+    size) and the bits of all the dimensions are interleaved while they last, so that a
+    4096x64x64 grid takes 2^24 slots and not 4096^3. Rounding each dimension up to a power
+    of two wastes at most 2^ndims times the cells of the grid (a 257x257x257 grid takes
+    512^3 slots), smaller when the sizes are close to powers of two. Slots out of the grid
+    are set as occupied by nDGridMap::resize() and they are never expanded by solvers.
+
+    Use it as nDGridMap<FMCell, ndims, MortonLayout<ndims> >. Indices are not consecutive
+    in the real cells, always use coord2idx() and idx2coord() to address the grid.
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MORTONLAYOUT_HPP_
+#define MORTONLAYOUT_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+#include <fast_methods/console/console.h>
+
+template <size_t ndims, class I = unsigned int> class MortonLayout {
+    public:
+        /** \brief Type of the indices (unsigned int by default, size_t for grids over 2^32 cells). */
+        typedef I index_t;
+
+        /** \brief True if the container has slots which are not cells of the grid. */
+        static constexpr bool padded = true;
+
+        /** \brief Computes the bits of each dimension and their masks. */
+        void resize
+        (const std::array<unsigned int, ndims> & dimsize) {
+            dimsize_ = dimsize;
+            std::array<unsigned int, ndims> bits;
+            unsigned int maxbits = 0, totalbits = 0;
+            for (size_t i = 0; i < ndims; ++i) {
+                bits[i] = 0;
+                while ((1ull << bits[i]) < dimsize_[i])
+                    ++bits[i];
+                maxbits = std::max(maxbits, bits[i]);
+                totalbits += bits[i];
+            }
+
+            if (totalbits >= 8*sizeof(index_t)) {
+                console::error("Grid too large for the index type of MortonLayout. Use MortonLayout<ndims, size_t>.");
+                exit(1);
+            }
+
+            // Bit b of every dimension which still has bits, lowest dimension first.
+            masks_.fill(0);
+            unsigned int pos = 0;
+            for (unsigned int b = 0; b < maxbits; ++b)
+                for (size_t i = 0; i < ndims; ++i)
+                    if (b < bits[i])
+                        masks_[i] |= index_t(1) << pos++;
+
+            // Dilated integers keep the order, so the last coordinate can be compared in Morton space.
+            for (size_t i = 0; i < ndims; ++i)
+                last_[i] = deposit(dimsize_[i] - 1, masks_[i]);
+            size_ = index_t(1) << totalbits;
+        }
+
+        /** \brief Returns the number of slots required in the container (Morton hypercube). */
+        inline index_t size
+        () const {
+            return size_;
+        }
+
+        /** \brief Returns true if slot idx is out of the grid. */
+        bool isPadding
+        (index_t idx) const {
+            for (size_t i = 0; i < ndims; ++i)
+                if ((idx & masks_[i]) > last_[i])
+                    return true;
+            return false;
+        }
+
+        /** \brief Transforms from coordinates to index by interleaving their bits. */
+        inline index_t coord2idx
+        (const std::array<unsigned int, ndims> & coords) const {
+            index_t idx = 0;
+            for (size_t i = 0; i < ndims; ++i)
+                idx |= deposit(coords[i], masks_[i]);
+            return idx;
+        }
+
+        /** \brief Transforms from index to coordinates. */
+        inline void idx2coord
+        (index_t idx, std::array<unsigned int, ndims> & coords) const {
+            for (size_t i = 0; i < ndims; ++i)
+                coords[i] = extract(idx, masks_[i]);
+        }
+
+        /** \brief Returns the index of the n-th cell in row-major order. */
+        inline index_t rowMajor2idx
+        (index_t n) const {
+            std::array<unsigned int, ndims> coords;
+            for (size_t i = 0; i < ndims; ++i) {
+                coords[i] = n % dimsize_[i];
+                n /= dimsize_[i];
+            }
+            return coord2idx(coords);
+        }
+
+        /** \brief Returns the index of the cell next to idx in dimension dim, towards dir (-1 or 1).
+            No boundary checks are done. */
+        inline index_t step
+        (index_t idx, unsigned int dim, int dir) const {
+            return (dir > 0) ? inc(idx, dim) : dec(idx, dim);
+        }
+
+        /** \brief Stores the valid neighbors of cell idx in dimension dim in neighs[n], neighs[n+1],
+            incrementing n accordingly. */
+        template <size_t N>
+        inline void getNeighborsInDim
+        (index_t idx, std::array<index_t, N> & neighs, unsigned int & n, unsigned int dim) const {
+            const index_t c = idx & masks_[dim];
+            if (c != 0)
+                neighs[n++] = dec(idx, dim);
+            if (c < last_[dim])
+                neighs[n++] = inc(idx, dim);
+        }
+
+        /** \brief Computes the indices of the 4-connectivity neighbors of cell idx. Returns
+            the number of neighbors found. */
+        inline unsigned int getNeighbors
+        (index_t idx, std::array<index_t, 2*ndims> & neighs) const {
+            unsigned int n = 0;
+            for (unsigned int i = 0; i < ndims; ++i)
+                getNeighborsInDim(idx, neighs, n, i);
+            return n;
+        }
+
+        /** \brief Returns the name of the layout. */
+        static std::string name
+        () {
+            return std::string("Morton");
+        }
+
+    private:
+        /** \brief Adds 1 to the coordinate dim of idx in Morton space. */
+        inline index_t inc
+        (index_t idx, unsigned int dim) const {
+            return (((idx | ~masks_[dim]) + 1) & masks_[dim]) | (idx & ~masks_[dim]);
+        }
+
+        /** \brief Subtracts 1 to the coordinate dim of idx in Morton space. */
+        inline index_t dec
+        (index_t idx, unsigned int dim) const {
+            return (((idx & masks_[dim]) - 1) & masks_[dim]) | (idx & ~masks_[dim]);
+        }
+
+        /** \brief Scatters the lower bits of x to the positions of the bits set in mask. */
+        static inline index_t deposit
+        (index_t x, index_t mask) {
+#ifdef __BMI2__
+            if (sizeof(index_t) > 4)
+                return _pdep_u64(x, mask);
+            return _pdep_u32(x, mask);
+#else
+            index_t r = 0;
+            for (index_t b = 1; mask; b <<= 1) {
+                if (x & b)
+                    r |= mask & -mask; // Lowest bit set in mask.
+                mask &= mask - 1;
+            }
+            return r;
+#endif
+        }
+
+        /** \brief Gathers the bits of x in the positions set in mask as the lower bits of the result. */
+        static inline index_t extract
+        (index_t x, index_t mask) {
+#ifdef __BMI2__
+            if (sizeof(index_t) > 4)
+                return _pext_u64(x, mask);
+            return _pext_u32(x, mask);
+#else
+            index_t r = 0;
+            for (index_t b = 1; mask; b <<= 1) {
+                if (x & mask & -mask)
+                    r |= b;
+                mask &= mask - 1;
+            }
+            return r;
+#endif
+        }
+
+        /** \brief Size of each dimension. */
+        std::array<unsigned int, ndims> dimsize_;
+
+        /** \brief Bits of the index used by each coordinate. */
+        std::array<index_t, ndims> masks_;
+
+        /** \brief Last valid coordinate of each dimension, dilated (in Morton space). */
+        std::array<index_t, ndims> last_;
+
+        /** \brief Number of slots. */
+        index_t size_;
+};
+
+#endif /* MORTONLAYOUT_HPP_*/
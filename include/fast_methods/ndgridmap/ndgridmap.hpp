@@ -7,8 +7,34 @@
     implemented, according to this document [nDGridMaps](http://javiervgomez.com/pages/n-dimensional-gridmaps-formulation-and-implementation.html)
     It is important to read this document in order to understand the class.
 
-    It has 2 template parameters: - the cells employed, should be Cell class or inherited.
+    It has 3 template parameters: - the cells employed, should be Cell class or inherited.
                                   - number of dimensions of the grid. Helps compiler to optimize.
+                                  - memory layout: how coordinates are mapped to indices and how
+                                    neighbors are computed. LinearLayout (row-major, default),
+                                    PaddedLayout (ghost border, branch-free neighbors),
+                                    BrickLayout (cubic tiles, locality in every dimension) or
+                                    MortonLayout (Z-order curve).
+
+    The indices of the cells depend on the layout, use coord2idx() and idx2coord() instead of
+    computing them. size() is the number of indices (ghost cells included) and getNCells() the
+    number of actual cells of the grid.
+
+    Cells are stored in the container given by nDGridStorage<T>. By default, it is
+    an array of cells (std::vector<T>). Other cell types can specialize it to change
+    the memory layout, for instance FMCellSoA stores every cell member in its own
+    contiguous array (structure of arrays), FMCellSparse only allocates the blocks
+    of cells which are modified (sparse grids) and FMCellShared shares the velocities
+    among all the copies of the grid. In those cases, cells are accessed through
+    lightweight proxies returned by value, so always use the reference typedef.
+
+    The speed statistics (getAvgSpeed(), getMaxSpeed() and getMinSpeed()) and the precomputed
+    slowness are cached. Modifying a cell through the non-const getCell() outdates them, but
+    operator[] does not, so that solvers can modify arrival times without recomputing them
+    in every run: call setSpeedsModified() after setting velocities with operator[].
+
+    Queries (neighbors, coordinates, cell values...) are const and do not modify the grid,
+    so that several threads can read the same grid at the same time, as long as none
+    of them modifies it.
 
     Copyright (C) 2014 Javier V. Gomez and Jose Pardeiro
     www.javiervgomez.com
@@ -36,21 +62,55 @@
 #include <array>
 #include <sstream>
 #include <cmath>
+#include <limits>
+#include <memory>
 
 #include <utility>
 
 #include <fast_methods/console/console.h>
+#include <fast_methods/ndgridmap/linearlayout.hpp>
 
-/// \todo Neighbors precomputation could speed things up.
 /// \todo Improve coord2idx function in order to just pass n coordinates and not an array.
-/// \todo Create d_ with 1 and d_[1] size of X, d_[2] size of Y, etc, to generalize dimensions.
 
-template <class T, size_t ndims> class nDGridMap {
+/** \brief Container used by nDGridMap to store cells of type T. Specialize it to
+    provide a different storage (see FMCellSoA and FMCellSparse). The container must
+    provide resize(), clear(), size(), operator[] and the reference and const_reference
+    typedefs. The specialization also provides the whole-grid operations, so that
+    storages which do not keep every cell can avoid visiting all of them. */
+template <class T> struct nDGridStorage {
+    typedef std::vector<T> type;
+
+    /** \brief Type in which arrival times and velocities are stored. Cells always take and
+        return doubles, but solvers compare times with the precision stored (see
+        utils::isTimeBetterThan()). */
+    typedef double value_t;
+
+    /** \brief True if setDefault() is O(1) (for instance, with epoch stamps), so that
+        it is not worth to clean only the modified cells. */
+    static constexpr bool stamped = false;
+
+    /** \brief Sets the index_ member of the cells, called after resizing. */
+    static void setIndices
+    (type & cells) {
+        for (size_t i = 0; i < cells.size(); ++i)
+            cells[i].setIndex(i);
+    }
+
+    /** \brief Calls setDefault() for all the cells. */
+    static void setDefault
+    (type & cells) {
+        for (size_t i = 0; i < cells.size(); ++i)
+            cells[i].setDefault();
+    }
+};
+
+template <class T, size_t ndims, class L = LinearLayout<ndims> > class nDGridMap {
 
     friend std::ostream& operator <<
-    (std::ostream & os, nDGridMap<T,ndims> & g) {
+    (std::ostream & os, const nDGridMap<T,ndims,L> & g) {
         os << console::str_info("Grid cell information");
-        os << "\t" << g.getCell(0).type() << std::endl;
+        os << "\t" << g.getCell(g.coord2idx(std::array<unsigned int, ndims>())).type() << std::endl;
+        os << "\t" << L::name() << " layout." << std::endl;
         os << "\t" << g.ncells_ << " cells." << std::endl;
         os << "\t" << g.leafsize_ << " leafsize (m)." << std::endl;
         os << "\t" << ndims << " dimensions:" << std::endl;
@@ -62,15 +122,50 @@ template <class T, size_t ndims> class nDGridMap {
     }
 
     public:
+        /** \brief Type of the cells of the grid. */
+        typedef T cell_t;
+
+        /** \brief Container of the cells. */
+        typedef typename nDGridStorage<T>::type storage_t;
+
+        /** \brief Type returned when accessing a cell. T& unless a proxy is used. */
+        typedef typename storage_t::reference reference;
+
+        /** \brief Type returned when accessing a cell of a const grid. const T& unless a proxy is used. */
+        typedef typename storage_t::const_reference const_reference;
+
+        /** \brief Type in which arrival times and velocities are stored: double unless the
+            storage is single precision (FMCellFloat). */
+        typedef typename nDGridStorage<T>::value_t value_t;
+
+        /** \brief Memory layout of the grid. */
+        typedef L layout_t;
+
+        /** \brief Type of the indices, given by the layout: unsigned int by default (up to
+            2^32 cells, smaller heaps and index arrays) or size_t, for instance
+            LinearLayout<ndims, size_t>, for larger grids. */
+        typedef typename L::index_t index_t;
+
+        /** \brief Time to cross a cell, leafsize/velocity, and its square: the terms of the
+            Eikonal equation given by the cell (see setPrecomputedSlowness()). */
+        struct Slowness {
+            double t;
+            double tt;
+        };
+
+        static_assert(sizeof(typename T::index_t) >= sizeof(index_t),
+            "The cell type cannot store the indices of the layout: use FMCellSoA (or a cell with a 64-bit index_t) with 64-bit layouts.");
 
-      nDGridMap () : leafsize_(1.0f), clean_(true) {}
+      nDGridMap () : leafsize_(1.0f), clean_(true), speedsUpdated_(false),
+        useSlowness_(false), slownessUpdated_(false) {}
 
       /** @param dimsize constains the size of each dimension.
           @param leafsize real cell size (assumed to be cubic). 1 unit by default. */
         nDGridMap
         (const std::array<unsigned int, ndims> & dimsize, double leafsize = 1.0f) :
         leafsize_(leafsize),
-        clean_(true) {
+        clean_(true), speedsUpdated_(false),
+        useSlowness_(false), slownessUpdated_(false) {
             resize(dimsize);
         }
 
@@ -78,153 +173,142 @@ template <class T, size_t ndims> class nDGridMap {
         void resize
         (const std::array<unsigned int, ndims> & dimsize) {
             dimsize_ = dimsize;
-            // Computing the total number of cells and the auxiliar array d_.
+            // Computing the total number of cells.
             ncells_= 1;
-            for (unsigned int i = 0; i < ndims; ++i) {
+            for (unsigned int i = 0; i < ndims; ++i)
                 ncells_ *= dimsize_[i];
-                d_[i] = ncells_;
-            }
+            layout_.resize(dimsize_);
 
             //Resizing gridmap and initializing with default values.
             cells_.clear();
-            cells_.resize(ncells_, T());
+            cells_.resize(layout_.size());
 
             // Setting the index_ member of the cells, which a-priori is unknown.
-            for (unsigned int i = 0; i < cells_.size(); ++i)
-                cells_[i].setIndex(i);
+            nDGridStorage<T>::setIndices(cells_);
+
+            // Ghost cells are obstacles, so that they are never expanded.
+            if (layout_t::padded && layout_.size() != ncells_)
+                for (index_t i = 0; i < cells_.size(); ++i)
+                    if (layout_.isPadding(i))
+                        cells_[i].setOccupancy(0);
             clean_ = true;
+            speedsUpdated_ = false;
+            slownessUpdated_ = false;
+        }
+
+        /** \brief Returns the cell with index idx. Unlike getCell(), it does not outdate the
+            speed statistics nor the slowness: use it to modify arrival times and states (as
+            solvers do), call setSpeedsModified() after modifying velocities through it. */
+        inline reference operator[]
+        (index_t idx) {
+            return cells_[idx];
         }
 
         /** \brief Returns the cell with index idx. */
-        inline T & operator[]
-        (unsigned int idx) {
+        inline const_reference operator[]
+        (index_t idx) const {
             return cells_[idx];
         }
 
         /** \brief Returns the leaf size of the grid. */
         inline double getLeafSize() const { return leafsize_; }
 
-        inline void setLeafSize(const double leafsize) { leafsize_ = leafsize; }
+        /** \brief Sets the leaf size of the grid. The precomputed slowness, if any, is outdated. */
+        inline void setLeafSize(const double leafsize) { leafsize_ = leafsize; slownessUpdated_ = false; }
+
+        /** \brief Returns the cell with index idx, which can be modified. Since its velocity
+            might change, the speed statistics and the slowness are marked as outdated. */
+        inline reference getCell
+        (index_t idx) {
+            setSpeedsModified();
+            return cells_[idx];
+        }
 
         /** \brief Returns the cell with index idx. */
-        inline T & getCell
-        (unsigned int idx) {
+        inline const_reference getCell
+        (index_t idx) const {
             return cells_[idx];
-            }
+        }
 
         /** \brief Returns the size of each dimension. */
         inline std::array<unsigned int, ndims> getDimSizes() const { return dimsize_;}
 
-         /** \brief Returns the minimum value of neighbors of cell idx in dimension dim. */
-        double getMinValueInDim
-        (unsigned int idx, unsigned int dim) {
-            n_neighs = 0; // How many neighbors obtained in that dimension.
-            getNeighborsInDim(idx,n_,dim);
+        /** \brief Returns the container of the cells, for storage-specific operations
+            (for instance, mapping a file with FMCellMapped). */
+        inline storage_t & getStorage() { return cells_; }
 
-            if (n_neighs == 1)
-                return cells_[n_[0]].getValue();
-            else
-                return (cells_[n_[0]].getValue()<cells_[n_[1]].getValue()) ? cells_[n_[0]].getValue() : cells_[n_[1]].getValue();
+        /** \brief Returns the minimum value of neighbors of cell idx in dimension dim. */
+        double getMinValueInDim
+        (index_t idx, unsigned int dim) const {
+            std::array<index_t, 2> n;
+            const unsigned int n_neighs = getNeighborsInDim(idx, n, dim);
+            double min = std::numeric_limits<double>::infinity();
+            for (unsigned int i = 0; i < n_neighs; ++i)
+                min = std::min(min, double(cells_[n[i]].getValue()));
+            return min;
         }
 
         /** \brief Returns number of valid neighbors for cell idx in dimension dim, stored in m. */
         unsigned int getNumberNeighborsInDim
-        (int idx, std::array<unsigned int, ndims> &m, unsigned int dim)   {
-            n_neighs = 0;
-            getNeighborsInDim(idx,n_,dim);
-            m = n_;
-            return n_neighs;
+        (index_t idx, std::array<index_t, 2> &m, unsigned int dim) const {
+            return getNeighborsInDim(idx, m, dim);
         }
 
         /** \brief Computes the indices of the 4-connectivity neighbors. As it is based
             on arrays (to improve performance) the number of neighbors found is
             returned since the neighs array will have always the same size. */
-        unsigned int getNeighbors
-        (unsigned int idx, std::array<unsigned int, 2*ndims> & neighs) {
-            n_neighs = 0;
-            for (unsigned int i = 0; i < ndims; ++i)
-                getNeighborsInDim(idx,neighs,i);
-
-            return n_neighs;
+        inline unsigned int getNeighbors
+        (index_t idx, std::array<index_t, 2*ndims> & neighs) const {
+            return layout_.getNeighbors(idx, neighs);
         }
 
         /** \brief Computes the indices of the 4-connectivity neighbors of cell idx in a specified direction dim.
-            This function is designed to be used within getNeighbors() or getMinValueInDim()
-            since it increments the private member n_neighs and it is only reset in
-            those functions. */
-        void getNeighborsInDim
-        (unsigned int idx, std::array<unsigned int, 2*ndims>& neighs, unsigned int dim) {
-            unsigned int c1,c2; // Candidate neighbors in dimension.
-            if (dim == 0) {
-                c1 = idx-1;
-                c2 = idx+1;
-            }
-            else {
-                c1 = idx-d_[dim-1];
-                c2 = idx+d_[dim-1];
-            }
-            // Checking neighbor 1: is in the same n-dimensional slice (row, plane, cube, etc)?
-            if ((c1 >= 0) && (c1/d_[dim] == idx/d_[dim]))
-                neighs[n_neighs++] = c1;
-            // Checking neighbor 2. Full check, not necessary: if >ncells_ then is in another slice.
-            if (c2/d_[dim] == idx/d_[dim])
-                neighs[n_neighs++] = c2;
-        }
-
-        /** \brief Special version (because of neighbors array size) of this function to be used with getMinValueInDim(). */
-        void getNeighborsInDim
-        (unsigned int idx, std::array<unsigned int, 2>& neighs, unsigned int dim) {
-            // Candidate neighbors in dimension.
-            unsigned int c1,c2;
-            if (dim == 0) {
-                c1 = idx-1;
-                c2 = idx+1;
-            }
-            else {
-                c1 = idx-d_[dim-1];
-                c2 = idx+d_[dim-1];
-            }
-            // Checking neighbor 1: is in the same n-dimensional slice (row, plane, cube, etc)?
-            if ((c1 >= 0) && (c1/d_[dim] == idx/d_[dim]))
-                neighs[n_neighs++] = c1;
-            // Checking neighbor 2. Full check, not necessary: if >ncells_ then is in another slice.
-            if (c2/d_[dim] == idx/d_[dim])
-                neighs[n_neighs++] = c2;
+            They are stored from neighs[0] and the number of neighbors found is returned. */
+        template <size_t N>
+        inline unsigned int getNeighborsInDim
+        (index_t idx, std::array<index_t, N>& neighs, unsigned int dim) const {
+            unsigned int n = 0;
+            layout_.getNeighborsInDim(idx, neighs, n, dim);
+            return n;
+        }
+
+        /** \brief Returns the index of the cell next to idx in dimension dim, towards dir (-1 or 1).
+            No boundary checks are done. */
+        inline index_t step
+        (index_t idx, unsigned int dim, int dir) const {
+            return layout_.step(idx, dim, dir);
         }
 
         /** \brief Transforms from index to coordinates. */
         unsigned int idx2coord
-        (unsigned int idx, std::array<unsigned int, ndims> & coords) {
-            if (coords.size() != ndims)
-                return -1;
-            else {
-                coords[ndims-1] = idx/d_[ndims-2]; // First step done apart.
-                unsigned int aux = idx - coords[ndims-1]*d_[ndims-2];
-                for (unsigned int i = ndims - 2; i > 0; --i) {
-                    coords[i] = aux/d_[i-1];
-                    aux -= coords[i]*d_[i-1];
-                }
-                coords[0] = aux; //Last step done apart.
-            }
+        (index_t idx, std::array<unsigned int, ndims> & coords) const {
+            layout_.idx2coord(idx, coords);
             return 1;
         }
 
         /** \brief Transforms from coordinates to index. */
         unsigned int coord2idx
-        (const std::array<unsigned int, ndims> & coords, unsigned int & idx) {
-            if (coords.size() != ndims)
-                return -1;
-            else {
-                idx = coords[0];
-                for(unsigned int i = 1; i < ndims; ++i)
-                    idx += coords[i]*d_[i-1];
-            }
+        (const std::array<unsigned int, ndims> & coords, index_t & idx) const {
+            idx = layout_.coord2idx(coords);
             return 1;
         }
 
+        /** \brief Returns the index of the coordinates given. */
+        inline index_t coord2idx
+        (const std::array<unsigned int, ndims> & coords) const {
+            return layout_.coord2idx(coords);
+        }
+
+        /** \brief Returns the index of the n-th cell of the grid in row-major order (first
+            dimension changes fastest), the order used by grid files. n for LinearLayout. */
+        inline index_t rowMajor2idx
+        (index_t n) const {
+            return layout_.rowMajor2idx(n);
+        }
+
        /** \brief Shows the coordinates from an index. */
         void showCoords
-        (unsigned int idx) {
+        (index_t idx) const {
             std::array<unsigned int, ndims> coords;
             idx2coord(idx, coords);
             for (unsigned int i = 0; i < ndims; ++i)
@@ -234,7 +318,7 @@ template <class T, size_t ndims> class nDGridMap {
 
         /** \brief Shows the coordinates from a set of coordinates. */
          void showCoords
-         (std::array<unsigned int, ndims> coords) {
+         (std::array<unsigned int, ndims> coords) const {
              for (unsigned int i = 0; i < ndims; ++i)
                  std::cout << coords[i] << "\t";
              std::cout << '\n';
@@ -242,25 +326,34 @@ template <class T, size_t ndims> class nDGridMap {
 
         /** \brief Shows the index from the coordinates. */
         void showIdx
-        (const std::array<unsigned int, ndims> & coords) {
-            unsigned int idx;
+        (const std::array<unsigned int, ndims> & coords) const {
+            index_t idx;
             coord2idx(coords, idx);
             std::cout << idx << '\n';
         }
 
-         /** \brief Returns number of cells in the grid. */
-        inline unsigned int size
+         /** \brief Returns number of indices of the grid, ghost cells included. Use it
+             to size arrays indexed by cell index. */
+        inline index_t size
+        () const {
+            return cells_.size();
+        }
+
+        /** \brief Returns number of cells in the grid (ghost cells not included). */
+        inline index_t getNCells
         () const {
             return ncells_;
         }
 
-        /** \brief Returns the maximum value of the cells in the grid. */
+        /** \brief Returns the maximum value of the cells in the grid. Not cached: values change
+            in every run and it is called once after each run (FM2 and GridPlotter), so a cache
+            would never be reused. Written as a branch-free reduction so that it can be vectorized. */
         inline double getMaxValue
         () const {
             double max = 0;
-            for (const T & c:cells_) {
-                if (!(std::isinf(c.getValue())) && c.getValue() > max)
-                    max = c.getValue();
+            for (index_t i = 0; i < cells_.size(); ++i) {
+                const double v = cells_[i].getValue();
+                max = (v > max && !std::isinf(v)) ? v : max;
             }
             return max;
         }
@@ -281,8 +374,22 @@ template <class T, size_t ndims> class nDGridMap {
         void clean
         () {
             if(!clean_) {
-                for (T & c:cells_)
-                    c.setDefault();
+                nDGridStorage<T>::setDefault(cells_);
+                clean_ = true;
+            }
+        }
+
+        /** \brief Cleans the grid if it is not clean already, knowing that only the cells
+            in modified have changed since it was clean (dirty list). Calls Cell::setDefault()
+            for those cells only, unless the storage is stamped. */
+        void clean
+        (const std::vector<index_t> & modified) {
+            if(!clean_) {
+                if (nDGridStorage<T>::stamped)
+                    nDGridStorage<T>::setDefault(cells_);
+                else
+                    for (index_t i : modified)
+                        cells_[i].setDefault();
                 clean_ = true;
             }
         }
@@ -292,11 +399,14 @@ template <class T, size_t ndims> class nDGridMap {
         () {
             cells_.clear();
             occupied_.clear();
+            slowness_.reset();
+            speedsUpdated_ = false;
+            slownessUpdated_ = false;
         }
 
         /** \brief Returns "size(dim(0)) \t size(dim(1)) \t..." */
-        std::string getDimSizesStr()
-        {
+        std::string getDimSizesStr
+        () const {
             std::stringstream ss;
             for(const auto& d : dimsize_)
                 ss << d << "\t";
@@ -305,52 +415,178 @@ template <class T, size_t ndims> class nDGridMap {
 
         /** \brief Sets the cells which are occupied. Usually called by grid loaders. */
         inline void setOccupiedCells
-        (const std::vector<unsigned int> & obs) {
+        (const std::vector<index_t> & obs) {
             occupied_ = obs;
+            speedsUpdated_ = false;
+            slownessUpdated_ = false;
         }
 
         /** \brief Sets (by move semantics) the cells which are occupied. Usually called by grid loaders. */
         inline void setOccupiedCells
-        (std::vector<unsigned int>&& obs) {
+        (std::vector<index_t>&& obs) {
             occupied_ = std::move(obs);
+            speedsUpdated_ = false;
+            slownessUpdated_ = false;
         }
 
         /** \brief Returns the indices of the occupied cells of the grid. */
         inline void getOccupiedCells
-        (std::vector<unsigned int> & obs) const {
+        (std::vector<index_t> & obs) const {
             obs = occupied_;
         }
 
         /** \brief Makes the number of dimensions of the grid available at compilation time. */
         static constexpr size_t getNDims() {return ndims;}
 
-        /** \brief Returns the avegare velocity ignoring those with 0 velocitie (obstacles). */
+        /** \brief Returns the avegare velocity ignoring those with 0 velocitie (obstacles).
+            Cached until the velocities are modified (see setSpeedsModified()). */
         double getAvgSpeed
         () {
-            double sum = 0;
-            unsigned int nObs = 0;
-            for (const T & c : cells_) {
-                if (!c.isOccupied())
-                    sum += c.getVelocity();
-                else
-                    ++nObs;
-            }
-            return sum/(ncells_ - nObs);
+            if (!speedsUpdated_)
+                updateSpeeds();
+            return avgSpeed_;
         }
 
-        /** \brief Returns the maximum speed (occupancy value) in the grid. */
+        /** \brief Returns the avegare velocity ignoring those with 0 velocitie (obstacles).
+            Computed if it is not cached, but the cache is not modified (thread-safe). */
+        double getAvgSpeed
+        () const {
+            if (speedsUpdated_)
+                return avgSpeed_;
+            double avg, min, max;
+            computeSpeeds(avg, min, max);
+            return avg;
+        }
+
+        /** \brief Returns the maximum speed (occupancy value) in the grid. Cached until the
+            velocities are modified (see setSpeedsModified()). */
         double getMaxSpeed
         () {
-            double max = 0;
-            for (const T & c : cells_)
-                if (max < c.getVelocity())
-                    max = c.getVelocity();
+            if (!speedsUpdated_)
+                updateSpeeds();
+            return maxSpeed_;
+        }
+
+        /** \brief Returns the maximum speed (occupancy value) in the grid. Computed if it is
+            not cached, but the cache is not modified (thread-safe). */
+        double getMaxSpeed
+        () const {
+            if (speedsUpdated_)
+                return maxSpeed_;
+            double avg, min, max;
+            computeSpeeds(avg, min, max);
             return max;
         }
 
+        /** \brief Returns the minimum velocity ignoring obstacles (occupied cells). Cached until
+            the velocities are modified (see setSpeedsModified()). */
+        double getMinSpeed
+        () {
+            if (!speedsUpdated_)
+                updateSpeeds();
+            return minSpeed_;
+        }
+
+        /** \brief Returns the minimum velocity ignoring obstacles (occupied cells). Computed if it
+            is not cached, but the cache is not modified (thread-safe). */
+        double getMinSpeed
+        () const {
+            if (speedsUpdated_)
+                return minSpeed_;
+            double avg, min, max;
+            computeSpeeds(avg, min, max);
+            return min;
+        }
+
+        /** \brief Marks the cached speed statistics and the precomputed slowness as outdated.
+            Call it after modifying the velocities of the cells through operator[] (getCell(),
+            resize() and setOccupiedCells(), used by grid loaders, already do it). */
+        inline void setSpeedsModified
+        () {
+            speedsUpdated_ = false;
+            slownessUpdated_ = false;
+        }
+
+        /** \brief If true, the grid keeps the slowness of every cell (see getSlowness()), so that
+            the Eikonal update does not divide by the velocity. It takes 16 bytes per cell and it
+            is recomputed by updateSlowness() only when velocities or leaf size have changed.
+            Copies of the grid share it until they recompute it. False by default. */
+        void setPrecomputedSlowness
+        (bool s) {
+            useSlowness_ = s;
+            if (!s)
+                slowness_.reset();
+            slownessUpdated_ = false;
+        }
+
+        /** \brief Returns true if the slowness of the cells is precomputed. */
+        inline bool hasPrecomputedSlowness
+        () const {
+            return useSlowness_;
+        }
+
+        /** \brief Returns true if the slowness of the cells is precomputed and up to date, that
+            is, updateSlowness() was called after the last change of velocities or leaf size. */
+        inline bool isSlownessUpdated
+        () const {
+            return useSlowness_ && slownessUpdated_;
+        }
+
+        /** \brief Returns the slowness of the cell idx. Only if isSlownessUpdated(), the slowness
+            is not computed otherwise. */
+        inline const Slowness & getSlowness
+        (index_t idx) const {
+            return (*slowness_)[idx];
+        }
+
+        /** \brief Computes the slowness of all the cells if it is precomputed and outdated,
+            nothing to do otherwise. Called by Solver::compute(). */
+        void updateSlowness
+        () {
+            if (!useSlowness_ || slownessUpdated_)
+                return;
+            // Shared with other copies of the grid, which might still use it.
+            if (!slowness_ || slowness_.use_count() > 1)
+                slowness_ = std::make_shared<std::vector<Slowness> >();
+            slowness_->resize(cells_.size());
+            for (index_t i = 0; i < cells_.size(); ++i) {
+                // Same operations as EikonalSolver::solveEikonal(), so that results do not change.
+                const double vel = cells_[i].getVelocity();
+                (*slowness_)[i].t = leafsize_ / vel;
+                (*slowness_)[i].tt = leafsize_ * leafsize_ / (vel*vel);
+            }
+            slownessUpdated_ = true;
+        }
+
     private:
+        /** \brief Computes the average, minimum (both without obstacles) and maximum speeds in a
+            single pass over the grid. */
+        void computeSpeeds
+        (double & avg, double & min, double & max) const {
+            double sum = 0;
+            min = std::numeric_limits<double>::infinity();
+            max = 0;
+            index_t nObs = 0;
+            for (index_t i = 0; i < cells_.size(); ++i) {
+                const double v = cells_[i].getVelocity();
+                const bool occupied = cells_[i].isOccupied();
+                sum += occupied ? 0 : v;
+                nObs += occupied;
+                min = (!occupied && v < min) ? v : min;
+                max = (v > max) ? v : max;
+            }
+            avg = sum/(cells_.size() - nObs);
+        }
+
+        /** \brief Updates the cached speed statistics. */
+        void updateSpeeds
+        () {
+            computeSpeeds(avgSpeed_, minSpeed_, maxSpeed_);
+            speedsUpdated_ = true;
+        }
+
         /** \brief Main container for the class. */
-        std::vector<T> cells_;
+        storage_t cells_;
 
         /** \brief Size of each dimension. */
         std::array<unsigned int, ndims> dimsize_;
@@ -359,27 +595,37 @@ template <class T, size_t ndims> class nDGridMap {
         double leafsize_;
 
         /** \brief Number of cells in the grid (size) */
-        unsigned int ncells_;
+        index_t ncells_;
 
         /** \brief Flag to indicate if the grid is ready to use. */
         bool clean_;
 
-        // Auxiliar vectors to speed things up.
-        /** \brief Auxiliar array to speed up neighbor and indexing generalization:
-            stores parcial multiplications of dimensions sizes. d_[0] = dimsize_[0];
-            d_[1] = dimsize_[0]*dimsize_[1]; etc. */
-        std::array<unsigned int, ndims> d_;
+        /** \brief Maps coordinates to indices and computes neighbors. */
+        layout_t layout_;
+
+        /** \brief True if avgSpeed_, minSpeed_ and maxSpeed_ are up to date. */
+        bool speedsUpdated_;
+
+        /** \brief Cached average speed, see getAvgSpeed(). */
+        double avgSpeed_;
+
+        /** \brief Cached minimum speed, see getMinSpeed(). */
+        double minSpeed_;
+
+        /** \brief Cached maximum speed, see getMaxSpeed(). */
+        double maxSpeed_;
+
+        /** \brief True if the slowness of the cells is precomputed, see setPrecomputedSlowness(). */
+        bool useSlowness_;
 
-        /** \brief  Auxiliar array to speed up neighbor and indexing generalization:
-            for getMinValueInDim() function. */
-        std::array<unsigned int, 2> n_;
+        /** \brief True if slowness_ is up to date. */
+        bool slownessUpdated_;
 
-        /** \brief Internal variable that counts the number of neighbors found in
-            every iteration. Modified by getNeighbours(), getNeighborsInDim() and getMinValueInDim() functions. */
-        unsigned int n_neighs;
+        /** \brief Precomputed slowness of the cells, shared by the copies of the grid. */
+        std::shared_ptr<std::vector<Slowness> > slowness_;
 
         /** \brief Caches the occupied cells (obstacles). */
-        std::vector<unsigned int> occupied_;
+        std::vector<index_t> occupied_;
 };
 
 #endif /* NDGRIDCELL_HPP_*/
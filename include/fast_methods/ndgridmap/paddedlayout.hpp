@@ -0,0 +1,156 @@
+/*! \class PaddedLayout
+    \brief Row-major layout of nDGridMap with a ghost border of one cell around the grid.
+
+    The container is (dimsize_[0]+2)x(dimsize_[1]+2)x... and the ghost cells are set as
+    occupied by nDGridMap::resize(). Therefore, every cell of the grid has always 2*ndims
+    neighbors and they are computed with 2*ndims additions from a precomputed offsets
+    table, without any boundary check (no integer divisions). Solvers already discard
+    occupied neighbors, so ghost cells are never evaluated.
+
+    Use it as nDGridMap<FMCell, ndims, PaddedLayout<ndims> >. Indices are not consecutive
+    in the real cells, always use coord2idx() and idx2coord() to address the grid.
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PADDEDLAYOUT_HPP_
+#define PADDEDLAYOUT_HPP_
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+template <size_t ndims, class I = unsigned int> class PaddedLayout {
+    public:
+        /** \brief Type of the indices (unsigned int by default, size_t for grids over 2^32 cells). */
+        typedef I index_t;
+
+        /** \brief True if the container has slots which are not cells of the grid. */
+        static constexpr bool padded = true;
+
+        /** \brief Computes the strides and the neighbors offsets table for the given dimension sizes. */
+        void resize
+        (const std::array<unsigned int, ndims> & dimsize) {
+            dimsize_ = dimsize;
+            size_ = 1;
+            origin_ = 0;
+            for (size_t i = 0; i < ndims; ++i) {
+                stride_[i] = size_;
+                origin_ += size_;
+                size_ *= dimsize_[i] + 2;
+                offsets_[2*i] = -stride_[i]; // Unsigned wrap-around, added to the index.
+                offsets_[2*i+1] = stride_[i];
+            }
+        }
+
+        /** \brief Returns the number of slots required in the container (ghost cells included). */
+        inline index_t size
+        () const {
+            return size_;
+        }
+
+        /** \brief Returns true if slot idx is a ghost cell. */
+        bool isPadding
+        (index_t idx) const {
+            for (size_t i = ndims; i-- > 0; ) {
+                const unsigned int c = idx/stride_[i];
+                if (c == 0 || c == dimsize_[i] + 1)
+                    return true;
+                idx -= c*stride_[i];
+            }
+            return false;
+        }
+
+        /** \brief Transforms from coordinates to index. */
+        inline index_t coord2idx
+        (const std::array<unsigned int, ndims> & coords) const {
+            index_t idx = origin_;
+            for(size_t i = 0; i < ndims; ++i)
+                idx += coords[i]*stride_[i];
+            return idx;
+        }
+
+        /** \brief Transforms from index to coordinates. */
+        inline void idx2coord
+        (index_t idx, std::array<unsigned int, ndims> & coords) const {
+            idx -= origin_;
+            for (size_t i = ndims; i-- > 0; ) {
+                coords[i] = idx/stride_[i];
+                idx -= coords[i]*stride_[i];
+            }
+        }
+
+        /** \brief Returns the index of the n-th cell in row-major order. */
+        inline index_t rowMajor2idx
+        (index_t n) const {
+            index_t idx = origin_;
+            for (size_t i = 0; i < ndims; ++i) {
+                idx += (n % dimsize_[i])*stride_[i];
+                n /= dimsize_[i];
+            }
+            return idx;
+        }
+
+        /** \brief Returns the index of the cell next to idx in dimension dim, towards dir (-1 or 1).
+            No boundary checks are done. */
+        inline index_t step
+        (index_t idx, unsigned int dim, int dir) const {
+            return idx + dir*stride_[dim];
+        }
+
+        /** \brief Stores both neighbors of cell idx in dimension dim in neighs[n], neighs[n+1],
+            incrementing n accordingly. */
+        template <size_t N>
+        inline void getNeighborsInDim
+        (index_t idx, std::array<index_t, N> & neighs, unsigned int & n, unsigned int dim) const {
+            neighs[n++] = idx + offsets_[2*dim];
+            neighs[n++] = idx + offsets_[2*dim+1];
+        }
+
+        /** \brief Computes the indices of the 4-connectivity neighbors of cell idx. All
+            of them always exist (they can be ghost cells). Returns 2*ndims. */
+        inline unsigned int getNeighbors
+        (index_t idx, std::array<index_t, 2*ndims> & neighs) const {
+            // Constant trip count: completely unrolled by the compiler.
+            for (size_t i = 0; i < 2*ndims; ++i)
+                neighs[i] = idx + offsets_[i];
+            return 2*ndims;
+        }
+
+        /** \brief Returns the name of the layout. */
+        static std::string name
+        () {
+            return std::string("Padded");
+        }
+
+    private:
+        /** \brief Size of each dimension (without ghost cells). */
+        std::array<unsigned int, ndims> dimsize_;
+
+        /** \brief Distance between consecutive cells in each dimension. stride_[0] = 1;
+            stride_[1] = dimsize_[0]+2; etc. */
+        std::array<index_t, ndims> stride_;
+
+        /** \brief Offsets to the neighbors: -stride_[0], stride_[0], -stride_[1]... */
+        std::array<index_t, 2*ndims> offsets_;
+
+        /** \brief Index of the cell with coordinates (0,0,...). */
+        index_t origin_;
+
+        /** \brief Number of slots. */
+        index_t size_;
+};
+
+#endif /* PADDEDLAYOUT_HPP_*/
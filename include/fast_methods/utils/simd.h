@@ -0,0 +1,115 @@
+/*! \class SimdPack
+    \brief Minimal wrapper of the SIMD instructions for doubles used by the vectorized kernels.
+
+    SimdPack holds as many doubles as the widest instruction set enabled at compile time:
+    4 with AVX (-mavx, -mavx2, -march=native...), 2 with SSE2 (default on x86-64) and 1
+    otherwise. ScalarPack provides the same interface for a single double, so that kernels
+    are written once as templates and instantiated for both: SimdPack for the bulk of the
+    data and ScalarPack for the remainder.
+
+    All the operations are IEEE-754 compliant (sqrt() and div() are correctly rounded), so
+    that both packs give exactly the same results.
+
+    Copyright (C) 2015 Javier V. Gomez
+    www.javiervgomez.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIMD_H_
+#define SIMD_H_
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/** \brief Operations on a single double, with the same interface as SimdPack. */
+class ScalarPack {
+    public:
+        typedef double type;
+        typedef bool mask;
+
+        static constexpr unsigned int width = 1;
+
+        static inline type load(const double * p)          {return *p;}
+        static inline void store(double * p, type a)        {*p = a;}
+        static inline type set1(double a)                   {return a;}
+        static inline type add(type a, type b)              {return a + b;}
+        static inline type sub(type a, type b)              {return a - b;}
+        static inline type mul(type a, type b)              {return a * b;}
+        static inline type div(type a, type b)              {return a / b;}
+        static inline type sqrt(type a)                     {return std::sqrt(a);}
+        static inline type min(type a, type b)              {return std::min(a, b);}
+        static inline type max(type a, type b)              {return std::max(a, b);}
+        static inline mask lt(type a, type b)               {return a < b;}
+
+        /** \brief Returns a where m is true, b elsewhere. */
+        static inline type select(mask m, type a, type b)   {return m ? a : b;}
+};
+
+#if defined(__AVX__)
+
+class SimdPack {
+    public:
+        typedef __m256d type;
+        typedef __m256d mask;
+
+        static constexpr unsigned int width = 4;
+
+        static inline type load(const double * p)          {return _mm256_loadu_pd(p);}
+        static inline void store(double * p, type a)        {_mm256_storeu_pd(p, a);}
+        static inline type set1(double a)                   {return _mm256_set1_pd(a);}
+        static inline type add(type a, type b)              {return _mm256_add_pd(a, b);}
+        static inline type sub(type a, type b)              {return _mm256_sub_pd(a, b);}
+        static inline type mul(type a, type b)              {return _mm256_mul_pd(a, b);}
+        static inline type div(type a, type b)              {return _mm256_div_pd(a, b);}
+        static inline type sqrt(type a)                     {return _mm256_sqrt_pd(a);}
+        static inline type min(type a, type b)              {return _mm256_min_pd(b, a);}
+        static inline type max(type a, type b)              {return _mm256_max_pd(b, a);}
+        static inline mask lt(type a, type b)               {return _mm256_cmp_pd(a, b, _CMP_LT_OQ);}
+        static inline type select(mask m, type a, type b)   {return _mm256_blendv_pd(b, a, m);}
+};
+
+#elif defined(__SSE2__)
+
+class SimdPack {
+    public:
+        typedef __m128d type;
+        typedef __m128d mask;
+
+        static constexpr unsigned int width = 2;
+
+        static inline type load(const double * p)          {return _mm_loadu_pd(p);}
+        static inline void store(double * p, type a)        {_mm_storeu_pd(p, a);}
+        static inline type set1(double a)                   {return _mm_set1_pd(a);}
+        static inline type add(type a, type b)              {return _mm_add_pd(a, b);}
+        static inline type sub(type a, type b)              {return _mm_sub_pd(a, b);}
+        static inline type mul(type a, type b)              {return _mm_mul_pd(a, b);}
+        static inline type div(type a, type b)              {return _mm_div_pd(a, b);}
+        static inline type sqrt(type a)                     {return _mm_sqrt_pd(a);}
+        static inline type min(type a, type b)              {return _mm_min_pd(b, a);}
+        static inline type max(type a, type b)              {return _mm_max_pd(b, a);}
+        static inline mask lt(type a, type b)               {return _mm_cmplt_pd(a, b);}
+        static inline type select(mask m, type a, type b)   {return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));}
+};
+
+#else
+
+/** \brief No SIMD instructions available: kernels run on single doubles. */
+class SimdPack : public ScalarPack {};
+
+#endif
+
+#endif /* SIMD_H_*/
@@ -26,11 +26,23 @@ class utils {
             double precission issues. */
         static constexpr double COMP_MARGIN = std::numeric_limits<double>::epsilon() * 1e5;
 
+        /** \brief Margin to compare the time t with times stored as T. For doubles it is
+            COMP_MARGIN. Narrower types (float) add their rounding error, which is relative
+            to t: otherwise a time recomputed from the same neighbors would always look better
+            than its rounded stored value. */
+        template <class T = double>
+        static constexpr double compMargin
+        (double t) {
+            return (std::numeric_limits<T>::digits < std::numeric_limits<double>::digits) ?
+                COMP_MARGIN + std::numeric_limits<T>::epsilon() * t : COMP_MARGIN;
+        }
+
          /** \brief Returns true if t1 is at least epsilon-lower than t2, provides robust comparions
-             for doubles. */
+             for doubles. T is the type in which times are stored (see nDGridMap::value_t). */
+        template <class T = double>
         static bool isTimeBetterThan
         (double t1, double t2) {
-            return t1 + COMP_MARGIN < t2;
+            return t1 + compMargin<T>(t1) < t2;
         }
 
         /** \brief An user-implemented absolute value function for integer values. */
@@ -24,22 +24,35 @@ function bm = parseBenchmarkLog (path_to_file)
     hs = 5+bm.ndims+nstartpoints; % Header's length
 
     %% Parsing experiments. Might be a bit redundant.
-    bm.nexp = (length(txt)-hs)/3;
+    % 4 columns per run, 6 with the errors of single precision grids (FMCellFloat).
+    lines = regexp(strtrim(fileread(path_to_file)), '\n', 'split');
+    ncols = length(regexp(strtrim(lines{2}), '\s+', 'split'));
+    bm.nexp = (length(txt)-hs)/ncols;
     id = zeros(bm.nexp,1);
     idstr = cell(bm.nexp,1);
     solvers = cell(bm.nexp/bm.nruns,1);
     times = zeros(bm.nexp,1);
+    resets = zeros(bm.nexp,1);
+    errors = zeros(bm.nexp,2);
     for i = 1:bm.nexp
-        idx = hs+(i-1)*3 + 1;
+        idx = hs+(i-1)*ncols + 1;
         idstr{i} = txt{idx};
         id(i) = str2double(idstr(i));
         solvers{i} = txt{idx+1};
         times(i) = str2double(txt{idx+2});
+        resets(i) = str2double(txt{idx+3});
+        if ncols == 6
+            errors(i,:) = [str2double(txt{idx+4}) str2double(txt{idx+5})];
+        end
     end
 
-    bm.exp = cell(bm.nexp/bm.nruns,2);
+    bm.exp = cell(bm.nexp/bm.nruns,ncols-1);
     for i = 1:bm.nexp/bm.nruns
         bm.exp{i,1} = solvers{(i-1)*bm.nruns+1};
         bm.exp{i,2} = times((i-1)*bm.nruns+1:i*bm.nruns);
+        bm.exp{i,3} = resets((i-1)*bm.nruns+1:i*bm.nruns);
+        if ncols == 6
+            bm.exp{i,4} = errors((i-1)*bm.nruns+1:i*bm.nruns,1);
+            bm.exp{i,5} = errors((i-1)*bm.nruns+1:i*bm.nruns,2);
+        end
     end
-
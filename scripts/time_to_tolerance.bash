@@ -0,0 +1,58 @@
+#!/bin/bash
+
+# INSTRUCTIONS
+#
+# 1. Run the benchmarks with exact=1 at several resolutions, for instance:
+#    $ ./<path_to_scripts>/run_benchmarks.bash <path_to>/data/accuracy_cfg
+# 2. Run $ ./<path_to_scripts>/time_to_tolerance.bash <results_folder> <tolerance>
+#
+# For every solver and number of dimensions, it prints the fastest benchmark (usually the
+# coarsest grid) whose maximum error is below the tolerance, its mean time and the speedup
+# with respect to the time to tolerance of FMM.
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <results_folder> <tolerance>"
+    exit 1
+fi
+
+awk -v tol="$2" '
+function flush(   s) {
+    for (s in sum) {
+        t = sum[s]/runs[s]
+        k = ndims SUBSEP s
+        if (err[s] <= tol && (!(k in best) || t < best[k])) {
+            best[k] = t
+            bestName[k] = name
+            bestCells[k] = cells
+            bestErr[k] = err[s]
+        }
+    }
+    delete sum
+    delete runs
+    delete err
+}
+FNR == 1 {
+    flush()
+    name = $1
+    ndims = $3
+    cells = 1
+    for (i = 0; i < ndims; ++i)
+        cells *= $(4+i)
+    next
+}
+NF >= 6 {
+    sum[$2] += $3
+    runs[$2]++
+    if (!($2 in err) || $5 > err[$2])
+        err[$2] = $5
+}
+END {
+    flush()
+    printf "#Dims\tSolver\tBenchmark\t#Cells\tTime (ms)\tMax error\tSpeedup vs FMM\n"
+    for (k in best) {
+        split(k, p, SUBSEP)
+        f = p[1] SUBSEP "FMM"
+        speedup = (f in best && best[k] > 0) ? sprintf("%.2f", best[f]/best[k]) : "nan"
+        printf "%s\t%s\t%s\t%d\t%.3f\t%g\t%s\n", p[1], p[2], bestName[k], bestCells[k], best[k], bestErr[k], speedup
+    }
+}' "$1"/*.log | sort -t $'\t' -k1,1n -k5,5n
@@ -20,7 +20,15 @@
 #include <boost/variant.hpp>
 
 #include <fast_methods/ndgridmap/fmcell.h>
+#include <fast_methods/ndgridmap/fmcellsoa.h>
+#include <fast_methods/ndgridmap/fmcellsparse.h>
+#include <fast_methods/ndgridmap/fmcellmapped.h>
+#include <fast_methods/ndgridmap/fmcellshared.h>
+#include <fast_methods/ndgridmap/fmcellfloat.h>
 #include <fast_methods/ndgridmap/ndgridmap.hpp>
+#include <fast_methods/ndgridmap/paddedlayout.hpp>
+#include <fast_methods/ndgridmap/bricklayout.hpp>
+#include <fast_methods/ndgridmap/mortonlayout.hpp>
 
 #include <fast_methods/fm/fmm.hpp>
 #include <fast_methods/fm/fim.hpp>
@@ -36,6 +44,69 @@
 
 using namespace std;
 
+/** \brief Double precision grids are not compared with any reference. */
+template <class grid_t>
+void setReference
+(BenchmarkCFG &, Benchmark<grid_t> &) {}
+
+/** \brief Single precision grids (FMCellFloat) are compared with the same solvers on a
+    double precision grid (FMCellSoA, same layout), which are benchmarked first: their
+    log (benchmark_name_double.log) gives the times to compare with. */
+template <size_t ndims, class L>
+void setReference
+(BenchmarkCFG & bcfg, Benchmark<nDGridMap<FMCellFloat, ndims, L> > & b) {
+    typedef nDGridMap<FMCellSoA, ndims, L> ref_grid_t;
+    Benchmark<ref_grid_t> ref;
+    bcfg.configure<ref_grid_t, FMCellSoA>(ref);
+    ref.setName(bcfg.getValue<std::string>("benchmark.name") + "_double");
+    ref.setKeepSolutions(true);
+    ref.run();
+    b.setReference(ref.getSolutions());
+}
+
+/** \brief Configures and runs the benchmark on a grid of type grid_t. */
+template <class grid_t>
+void runBenchmark
+(BenchmarkCFG & bcfg) {
+    Benchmark<grid_t> b;
+    bcfg.configure<grid_t, typename grid_t::cell_t>(b);
+    setReference(bcfg, b);
+    b.run();
+}
+
+/** \brief Runs the benchmark with the grid layout selected in the CFG file. */
+template <class cell_t, size_t ndims, class index_t = unsigned int>
+void runWithLayout
+(BenchmarkCFG & bcfg) {
+    const std::string layout = bcfg.getValue<std::string>("grid.layout");
+    if (layout == "Linear")
+        runBenchmark<nDGridMap<cell_t, ndims, LinearLayout<ndims, index_t> > >(bcfg);
+    else if (layout == "Padded")
+        runBenchmark<nDGridMap<cell_t, ndims, PaddedLayout<ndims, index_t> > >(bcfg);
+    else if (layout == "Brick")
+        runBenchmark<nDGridMap<cell_t, ndims, BrickLayout<ndims, index_t> > >(bcfg);
+    else if (layout == "Morton")
+        runBenchmark<nDGridMap<cell_t, ndims, MortonLayout<ndims, index_t> > >(bcfg);
+    // Add layout here.
+    else
+        console::error("Unknown grid layout: " + layout);
+}
+
+/** \brief Runs the benchmark with the index type selected in the CFG file. Only
+    for cells which can store 64-bit indices (FMCellSoA, FMCellSparse, FMCellMapped, FMCellShared
+    and FMCellFloat). */
+template <class cell_t, size_t ndims>
+void runWithIndex
+(BenchmarkCFG & bcfg) {
+    const unsigned int bits = bcfg.getValue<unsigned int>("grid.index");
+    if (bits == 32)
+        runWithLayout<cell_t, ndims, unsigned int>(bcfg);
+    else if (bits == 64)
+        runWithLayout<cell_t, ndims, size_t>(bcfg);
+    else
+        console::error("Unknown index type: grid.index has to be 32 or 64.");
+}
+
 int main(int argc, const char ** argv)
 {
     // Parse input.
@@ -52,31 +123,90 @@ int main(int argc, const char ** argv)
         // If FMCell is used...
         if(bcfg.getValue<std::string>("grid.cell") == "FMCell")
         {
+            // FMCell stores its index in 32 bits to keep the cell small.
+            if (bcfg.getValue<unsigned int>("grid.index") != 32) {
+                console::error("64-bit indices require grid.cell=FMCellSoA, FMCellSparse, FMCellMapped, FMCellShared or FMCellFloat.");
+                return 1;
+            }
+
             // ... and for dimensions...
             switch (bcfg.getValue<unsigned int>("grid.ndims"))
             {
                 case 2:
-                {
-                    Benchmark<nDGridMap<FMCell,2> > b;
-                    bcfg.configure<nDGridMap<FMCell,2>, FMCell>(b);
-                    b.run();
+                    runWithLayout<FMCell, 2>(bcfg);
                     break;
-                }
                 case 3:
-                {
-                    Benchmark<nDGridMap<FMCell,3> > b;
-                    bcfg.configure<nDGridMap<FMCell,3>, FMCell>(b);
-                    b.run();
+                    runWithLayout<FMCell, 3>(bcfg);
                     break;
-                }
                 // Include here new dimensions copying, pasting and changing x.
                 /*case x:
-                {
-                    Benchmark<nDGridMap<FMCell,x> > b;
-                    bcfg.configure<nDGridMap<FMCell,x>, FMCell>(b);
-                    b.run();
+                    runWithLayout<FMCell, x>(bcfg);
+                    break;*/
+            }
+        }
+        // Same cell, but stored as a structure of arrays.
+        else if(bcfg.getValue<std::string>("grid.cell") == "FMCellSoA")
+        {
+            switch (bcfg.getValue<unsigned int>("grid.ndims"))
+            {
+                case 2:
+                    runWithIndex<FMCellSoA, 2>(bcfg);
+                    break;
+                case 3:
+                    runWithIndex<FMCellSoA, 3>(bcfg);
+                    break;
+            }
+        }
+        // Same cell, allocating only the blocks of cells modified.
+        else if(bcfg.getValue<std::string>("grid.cell") == "FMCellSparse")
+        {
+            switch (bcfg.getValue<unsigned int>("grid.ndims"))
+            {
+                case 2:
+                    runWithIndex<FMCellSparse, 2>(bcfg);
+                    break;
+                case 3:
+                    runWithIndex<FMCellSparse, 3>(bcfg);
+                    break;
+            }
+        }
+        // Same cell, in memory mappings (velocities mapped from grid.binary).
+        else if(bcfg.getValue<std::string>("grid.cell") == "FMCellMapped")
+        {
+            switch (bcfg.getValue<unsigned int>("grid.ndims"))
+            {
+                case 2:
+                    runWithIndex<FMCellMapped, 2>(bcfg);
+                    break;
+                case 3:
+                    runWithIndex<FMCellMapped, 3>(bcfg);
+                    break;
+            }
+        }
+        // Same cell, epoch-stamped (O(1) reset) and with shared velocities.
+        else if(bcfg.getValue<std::string>("grid.cell") == "FMCellShared")
+        {
+            switch (bcfg.getValue<unsigned int>("grid.ndims"))
+            {
+                case 2:
+                    runWithIndex<FMCellShared, 2>(bcfg);
+                    break;
+                case 3:
+                    runWithIndex<FMCellShared, 3>(bcfg);
+                    break;
+            }
+        }
+        // Same cell as FMCellSoA, in single precision. Errors are reported against FMCellSoA.
+        else if(bcfg.getValue<std::string>("grid.cell") == "FMCellFloat")
+        {
+            switch (bcfg.getValue<unsigned int>("grid.ndims"))
+            {
+                case 2:
+                    runWithIndex<FMCellFloat, 2>(bcfg);
+                    break;
+                case 3:
+                    runWithIndex<FMCellFloat, 3>(bcfg);
                     break;
-                }*/
             }
         }
         else // else if (bcfg.getValue<std::string>("grid.cell") == "MyCell") 
@@ -86,12 +216,8 @@ int main(int argc, const char ** argv)
             /*switch (bcfg.getValue<unsigned int>("grid.ndims"))
             {
                 case 2:
-                {
-                    Benchmark<nDGridMap<MyCell,2> > b;
-                    bcfg.configure<nDGridMap<MyCell,2>, MyCell>(b);
-                    b.run();
+                    runWithLayout<MyCell, 2>(bcfg);
                     break;
-                }
                 //...
             }*/
         }
@@ -12,8 +12,3 @@ ostream& operator <<
        << "\t" << "Occupancy: " << c.occupancy_ <<'\n';
     return os;
 }
-
-void Cell::setDefault
-() {
-    value_ = -1;
-}
@@ -26,12 +26,3 @@ ostream& operator <<
     os << '\n';
     return os;
 }
-
-void FMCell::setDefault
-() {
-    Cell::setDefault();
-    value_ = std::numeric_limits<double>::infinity();
-    bucket_ = 0;
-    hValue_ = 0;
-    state_ = FMState::OPEN;
-}
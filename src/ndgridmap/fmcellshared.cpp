@@ -0,0 +1,28 @@
+#include "fast_methods/ndgridmap/fmcellshared.h"
+
+#include <fast_methods/console/console.h>
+
+using namespace std;
+
+ostream& operator <<
+(ostream & os, const FMCellShared & c) {
+    os << console::str_info("Fast Marching cell (shared velocities) information:");
+    os << "\t" << "Index: " << c.getIndex() << '\n'
+       << "\t" << "Value: " << c.getValue() << '\n'
+       << "\t" << "Velocity: " << c.getVelocity() << '\n'
+       << "\t" << "State: " ;
+
+    switch (c.getState()) {
+        case FMState::OPEN:
+            os << "OPEN";
+            break;
+        case FMState::NARROW:
+            os << "NARROW";
+            break;
+        case FMState::FROZEN:
+            os << "FROZEN";
+            break;
+        }
+    os << '\n';
+    return os;
+}